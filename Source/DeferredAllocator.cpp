@@ -0,0 +1,63 @@
+/*
+  ==============================================================================
+
+    DeferredAllocator.cpp
+
+  ==============================================================================
+*/
+
+#include "DeferredAllocator.h"
+
+//==============================================================================
+DeferredAllocator::DeferredAllocator()
+{
+}
+
+DeferredAllocator::~DeferredAllocator()
+{
+    stopTimer();
+    jassert (mClients.isEmpty());
+}
+
+void DeferredAllocator::addClient (Client* client)
+{
+    const juce::ScopedLock lock (mLock);
+
+    mClients.addIfNotAlreadyThere (client);
+
+    if (! isTimerRunning())
+        startTimerHz (DEFERREDALLOCATORHZ);
+}
+
+void DeferredAllocator::removeClient (Client* client)
+{
+    // taking the lock also waits out a timer callback that is calling this client
+    const juce::ScopedLock lock (mLock);
+
+    mClients.removeFirstMatchingValue (client);
+
+    // the tick below only gets this far when something was asked for
+    if (mClients.isEmpty())
+        stopTimer();
+}
+
+void DeferredAllocator::notifyRequested() noexcept
+{
+    mRequested = true;
+}
+
+void DeferredAllocator::timerCallback()
+{
+    // nothing has asked since the last poll, which answered everything asked before it
+    if (! mRequested.exchange (false))
+        return;
+
+    const juce::ScopedLock lock (mLock);
+
+    for (int i = mClients.size(); --i >= 0;)
+        if (mClients.getUnchecked (i)->performDeferredAllocation())
+            mClients.remove (i);
+
+    if (mClients.isEmpty())
+        stopTimer();
+}
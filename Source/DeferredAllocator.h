@@ -0,0 +1,71 @@
+/*
+  ==============================================================================
+
+    DeferredAllocator.h
+
+    Message-thread allocation on behalf of the audio thread.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// how often pending requests are looked at; the dry signal passes until then
+#define DEFERREDALLOCATORHZ 20
+
+//==============================================================================
+/**
+    One timer shared by every instance in the process. Hold it through a
+    juce::SharedResourcePointer<DeferredAllocator>.
+
+    A client registers while it may need memory it hasn't got (after
+    prepareToPlay, say). When the audio thread wants the memory it sets a flag
+    of its own and calls notifyRequested(); the timer then polls the registered
+    clients and does the allocation on the message thread. Unlike AsyncUpdater,
+    nothing on the audio thread posts a message or takes a lock.
+
+    The audio thread can't start a timer, so it runs for as long as anyone is
+    registered, including prepared instances that have only ever seen silence.
+    Until something asks for memory, though, a tick is a single atomic
+    exchange, however many instances are waiting.
+*/
+class DeferredAllocator  : private juce::Timer
+{
+public:
+    struct Client
+    {
+        virtual ~Client() = default;
+
+        /** Called on the message thread. Allocates whatever the audio thread has asked
+            for, and returns true once nothing is left to do, which unregisters the client.
+        */
+        virtual bool performDeferredAllocation() = 0;
+    };
+
+    DeferredAllocator();
+    ~DeferredAllocator() override;
+
+    /** Not from the audio thread. Registering twice is harmless. */
+    void addClient (Client* client);
+
+    /** Not from the audio thread. Once this returns the client won't be called again,
+        so call it before taking anything the client's allocation might touch.
+    */
+    void removeClient (Client* client);
+
+    /** Safe from the audio thread. Call after setting the client's own request flag,
+        so the next tick polls the clients instead of skipping them.
+    */
+    void notifyRequested() noexcept;
+
+private:
+    void timerCallback() override;
+
+    juce::CriticalSection mLock;
+    juce::Array<Client*> mClients;
+    std::atomic<bool> mRequested { false };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (DeferredAllocator)
+};
@@ -0,0 +1,112 @@
+/*
+  ==============================================================================
+
+    FlangerOscReceiver.cpp
+
+  ==============================================================================
+*/
+
+#include "FlangerOscReceiver.h"
+#include "PluginProcessor.h"
+
+//==============================================================================
+FlangerOscReceiver::FlangerOscReceiver (FlangerAudioProcessor& p)
+    : audioProcessor (p), mPort (0)
+{
+    mReceiver.addListener (this);
+}
+
+FlangerOscReceiver::~FlangerOscReceiver()
+{
+    disconnect();
+    mReceiver.removeListener (this);
+}
+
+bool FlangerOscReceiver::connect (int port, const juce::String& bindAddress)
+{
+    disconnect();
+
+    mSocket = std::make_unique<juce::DatagramSocket> (false);
+
+    if (! mSocket->bindToPort (port, bindAddress) || ! mReceiver.connectToSocket (*mSocket))
+    {
+        DBG("OSC: could not bind " + bindAddress + ":" + juce::String(port));
+        mSocket.reset();
+        return false;
+    }
+
+    mPort = port;
+    mBindAddress = bindAddress;
+    return true;
+}
+
+void FlangerOscReceiver::disconnect()
+{
+    mReceiver.disconnect();
+
+    if (mSocket != nullptr)
+        mSocket->shutdown();
+
+    mSocket.reset();
+    mPort = 0;
+}
+
+//==============================================================================
+void FlangerOscReceiver::oscMessageReceived (const juce::OSCMessage& message)
+{
+    if (message.size() != 1)
+        return;
+
+    auto& argument = message[0];
+    float value;
+
+    if (argument.isFloat32())
+        value = argument.getFloat32();
+    else if (argument.isInt32())
+        value = (float) argument.getInt32();
+    else
+        return;
+
+    FlangerCommand command;
+    command.value = value;
+
+    // returned by value, so hold a copy rather than a reference to the temporary
+    const auto pattern = message.getAddressPattern();
+
+    if (pattern.matches (mFrequencyAddress))
+        command.type = FlangerCommand::frequency;
+    else if (pattern.matches (mDepthAddress))
+        command.type = FlangerCommand::depth;
+    else if (pattern.matches (mFeedbackAddress))
+        command.type = FlangerCommand::feedback;
+    else if (pattern.matches (mLfoTypeAddress))
+        command.type = FlangerCommand::lfoType;
+    else if (pattern.matches (mMotionAddress))
+        command.type = FlangerCommand::motion;
+    else if (pattern.matches (mMorphAddress))
+        command.type = FlangerCommand::morph;
+    else if (pattern.matches (mClearAddress))
+        command.type = FlangerCommand::clear;
+    else if (pattern.matches (mSidechainDepthAddress))
+        command.type = FlangerCommand::sidechainDepth;
+    else if (pattern.matches (mSidechainDelayAddress))
+        command.type = FlangerCommand::sidechainDelay;
+    else if (pattern.matches (mBudgetAddress))
+        command.type = FlangerCommand::cpuBudget;
+    else
+        return;
+
+    if (! audioProcessor.pushCommand (command))
+        DBG("OSC: command queue full, dropped " + pattern.toString());
+}
+
+void FlangerOscReceiver::oscBundleReceived (const juce::OSCBundle& bundle)
+{
+    for (auto& element : bundle)
+    {
+        if (element.isMessage())
+            oscMessageReceived (element.getMessage());
+        else if (element.isBundle())
+            oscBundleReceived (element.getBundle());
+    }
+}
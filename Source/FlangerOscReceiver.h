@@ -0,0 +1,73 @@
+/*
+  ==============================================================================
+
+    FlangerOscReceiver.h
+
+    Remote control over OSC. Messages are decoded on the network thread and
+    handed to the processor's command queue, which processBlock drains.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+class FlangerAudioProcessor;
+
+//==============================================================================
+/**
+    Listens on a UDP port (bound to 127.0.0.1 unless told otherwise; pass
+    "0.0.0.0" to accept messages from other machines) and maps
+
+        /flanger/frequency  <float Hz>
+        /flanger/depth      <float 0-1>
+        /flanger/feedback   <float 0-1>
+        /flanger/lfotype    <int, 1 = sine ... 7 = user, see lfoType>
+        /flanger/morph      <float 0-6, between neighbouring shapes>
+        /flanger/motion     <int, 1 = contrary, 2 = sync>
+        /flanger/clear      <any number, kills the delay tail>
+        /flanger/sidechain/depth  <float 0-1, how far the sidechain ducks the depth>
+        /flanger/sidechain/delay  <float 0-1, how far it pushes the delay up>
+        /flanger/budget     <float 0-1, CPU governor budget as a share of the period, 0 = off>
+
+    onto FlangerCommands. Int and float arguments are accepted for all of
+    them, and bundles are unpacked. Decoding runs on the receiver's own thread
+    (RealtimeCallback), so a busy message thread doesn't add latency.
+*/
+class FlangerOscReceiver  : private juce::OSCReceiver::Listener<juce::OSCReceiver::RealtimeCallback>
+{
+public:
+    FlangerOscReceiver (FlangerAudioProcessor&);
+    ~FlangerOscReceiver() override;
+
+    bool connect (int port, const juce::String& bindAddress = "127.0.0.1");
+    void disconnect();
+
+    int getPort() const noexcept { return mPort; }
+    const juce::String& getBindAddress() const noexcept { return mBindAddress; }
+
+private:
+    void oscMessageReceived (const juce::OSCMessage& message) override;
+    void oscBundleReceived (const juce::OSCBundle& bundle) override;
+
+    FlangerAudioProcessor& audioProcessor;
+
+    juce::OSCReceiver mReceiver;
+    std::unique_ptr<juce::DatagramSocket> mSocket;
+    int mPort;
+    juce::String mBindAddress { "127.0.0.1" };
+
+    const juce::OSCAddress mFrequencyAddress { "/flanger/frequency" };
+    const juce::OSCAddress mDepthAddress     { "/flanger/depth" };
+    const juce::OSCAddress mFeedbackAddress  { "/flanger/feedback" };
+    const juce::OSCAddress mLfoTypeAddress   { "/flanger/lfotype" };
+    const juce::OSCAddress mMotionAddress    { "/flanger/motion" };
+    const juce::OSCAddress mMorphAddress     { "/flanger/morph" };
+    const juce::OSCAddress mClearAddress     { "/flanger/clear" };
+    const juce::OSCAddress mSidechainDepthAddress { "/flanger/sidechain/depth" };
+    const juce::OSCAddress mSidechainDelayAddress { "/flanger/sidechain/delay" };
+    const juce::OSCAddress mBudgetAddress    { "/flanger/budget" };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (FlangerOscReceiver)
+};
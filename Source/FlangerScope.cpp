@@ -0,0 +1,213 @@
+/*
+  ==============================================================================
+
+    FlangerScope.cpp
+
+  ==============================================================================
+*/
+
+#include "FlangerScope.h"
+
+//==============================================================================
+/** Tells the scope whenever it, or any component above it, is shown, hidden,
+    added to or removed from a window.
+*/
+class FlangerScope::ShowingWatcher  : public juce::ComponentMovementWatcher
+{
+public:
+    explicit ShowingWatcher (FlangerScope& s)
+        : juce::ComponentMovementWatcher (&s), scope (s)
+    {
+    }
+
+    void componentMovedOrResized (bool, bool) override {}
+    void componentPeerChanged() override            { scope.updateRunning(); }
+    void componentVisibilityChanged() override      { scope.updateRunning(); }
+
+private:
+    FlangerScope& scope;
+};
+
+//==============================================================================
+FlangerScope::FlangerScope (FlangerAudioProcessor& p)
+    : audioProcessor (p), mHistoryPos (0)
+{
+    setOpaque (true);
+
+    mShowingWatcher = std::make_unique<ShowingWatcher> (*this);
+    updateRunning();
+}
+
+FlangerScope::~FlangerScope()
+{
+    mShowingWatcher.reset();
+    stopTimer();
+    audioProcessor.setScopeEnabled (false);
+}
+
+void FlangerScope::updateRunning()
+{
+    auto showing = isShowing();
+
+    if (showing == isTimerRunning())
+        return;
+
+    if (showing)
+    {
+        // drop anything queued while the scope was hidden, then start publishing
+        ScopeSnapshot stale;
+        while (audioProcessor.popScopeSnapshot (stale)) {}
+
+        audioProcessor.setScopeEnabled (true);
+        startTimerHz (30);
+    }
+    else
+    {
+        stopTimer();
+        audioProcessor.setScopeEnabled (false);
+    }
+}
+
+//==============================================================================
+void FlangerScope::timerCallback()
+{
+    // a minimised window doesn't tell its children, so check here as well
+    if (! isShowing())
+    {
+        updateRunning();
+        return;
+    }
+
+    bool gotNewData = false;
+    ScopeSnapshot snapshot;
+
+    while (audioProcessor.popScopeSnapshot (snapshot))
+    {
+        mHistory[(size_t) mHistoryPos] = snapshot;
+        mHistoryPos = (mHistoryPos + 1) % SCOPEHISTORY;
+        gotNewData = true;
+    }
+
+    // a bypassed or stopped instance costs nothing beyond the empty FIFO check
+    if (gotNewData)
+        repaint();
+}
+
+//==============================================================================
+juce::Rectangle<float> FlangerScope::getPlotArea() const
+{
+    auto bounds = getLocalBounds().toFloat().reduced (6.0f);
+    return bounds.withTrimmedRight (bounds.getHeight() * 2.0f + 40.0f);
+}
+
+juce::Rectangle<float> FlangerScope::getPhaseArea (int lane) const
+{
+    auto bounds = getLocalBounds().toFloat().reduced (6.0f);
+    auto size = bounds.getHeight();
+    auto x = getPlotArea().getRight() + 6.0f + (float) lane * size;
+
+    return juce::Rectangle<float> (x, bounds.getY(), size, size).reduced (6.0f);
+}
+
+juce::Rectangle<float> FlangerScope::getLevelArea (int index) const
+{
+    auto bounds = getLocalBounds().toFloat().reduced (6.0f);
+    auto x = getPhaseArea (1).getRight() + 12.0f + (float) index * 14.0f;
+
+    return { x, bounds.getY(), 10.0f, bounds.getHeight() };
+}
+
+void FlangerScope::renderBackground()
+{
+    if (getWidth() <= 0 || getHeight() <= 0)
+        return;
+
+    mBackground = juce::Image (juce::Image::RGB, getWidth(), getHeight(), true);
+    juce::Graphics g (mBackground);
+
+    g.fillAll (juce::Colours::black);
+
+    auto plot = getPlotArea();
+    g.setColour (juce::Colours::darkgrey);
+
+    for (int i = 0; i <= 4; i++)
+    {
+        auto y = plot.getY() + plot.getHeight() * (float) i / 4.0f;
+        g.drawHorizontalLine ((int) y, plot.getX(), plot.getRight());
+    }
+
+    g.drawRect (plot);
+
+    for (int lane = 0; lane < 2; lane++)
+        g.drawEllipse (getPhaseArea (lane), 1.0f);
+
+    for (int index = 0; index < 2; index++)
+        g.drawRect (getLevelArea (index));
+
+    g.setColour (juce::Colours::grey);
+    g.setFont (11.0f);
+    g.drawText ("Delay", plot.reduced (4.0f), juce::Justification::topLeft);
+    g.drawText ("L", getPhaseArea (0), juce::Justification::centred);
+    g.drawText ("R", getPhaseArea (1), juce::Justification::centred);
+}
+
+void FlangerScope::resized()
+{
+    renderBackground();
+}
+
+void FlangerScope::paint (juce::Graphics& g)
+{
+    // nor does restoring it, but it does repaint us
+    if (! isTimerRunning())
+        updateRunning();
+
+    g.drawImageAt (mBackground, 0, 0);
+
+    const juce::Colour laneColours[] = { juce::Colours::magenta, juce::Colours::cyan };
+    auto plot = getPlotArea();
+
+    for (int lane = 0; lane < 2; lane++)
+    {
+        juce::Path curve;
+
+        for (int i = 0; i < SCOPEHISTORY; i++)
+        {
+            auto& snapshot = mHistory[(size_t) ((mHistoryPos + i) % SCOPEHISTORY)];
+            auto x = plot.getX() + plot.getWidth() * (float) i / (float) (SCOPEHISTORY - 1);
+            auto y = plot.getBottom() - plot.getHeight() * juce::jlimit (0.0f, 1.0f, snapshot.delayTime[lane]);
+
+            if (i == 0)
+                curve.startNewSubPath (x, y);
+            else
+                curve.lineTo (x, y);
+        }
+
+        g.setColour (laneColours[lane]);
+        g.strokePath (curve, juce::PathStrokeType (1.5f));
+    }
+
+    auto& latest = mHistory[(size_t) ((mHistoryPos + SCOPEHISTORY - 1) % SCOPEHISTORY)];
+
+    for (int lane = 0; lane < 2; lane++)
+    {
+        auto area = getPhaseArea (lane);
+        auto angle = juce::MathConstants<float>::twoPi * latest.lfoPhase[lane];
+        auto radius = area.getWidth() * 0.5f;
+        auto dot = area.getCentre() + juce::Point<float> (std::sin (angle), -std::cos (angle)) * radius;
+
+        g.setColour (laneColours[lane]);
+        g.fillEllipse (juce::Rectangle<float> (6.0f, 6.0f).withCentre (dot));
+    }
+
+    const float levels[] = { latest.inputLevel, latest.outputLevel };
+
+    for (int index = 0; index < 2; index++)
+    {
+        auto area = getLevelArea (index);
+        auto filled = area.withTop (area.getBottom() - area.getHeight() * juce::jlimit (0.0f, 1.0f, levels[index]));
+
+        g.setColour (juce::Colours::limegreen);
+        g.fillRect (filled);
+    }
+}
@@ -0,0 +1,59 @@
+/*
+  ==============================================================================
+
+    FlangerScope.h
+
+    Editor view of the live delay-time curve, LFO phases and levels.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "PluginProcessor.h"
+
+// number of snapshots shown across the width of the delay-time plot
+#define SCOPEHISTORY 128
+
+//==============================================================================
+/**
+    Drains the processor's scope FIFO on a 30 Hz timer and repaints only itself,
+    and only when new snapshots arrived. The grid and labels are drawn once per
+    resize into a cached image, so each frame is a blit plus a few paths.
+
+    The timer and the processor's publishing only run while the scope is
+    showing. Hiding it (or any parent), or taking it off screen, stops both,
+    so a closed or hidden editor costs neither thread anything.
+*/
+class FlangerScope  : public juce::Component, private juce::Timer
+{
+public:
+    FlangerScope (FlangerAudioProcessor&);
+    ~FlangerScope() override;
+
+    void paint (juce::Graphics&) override;
+    void resized() override;
+
+private:
+    class ShowingWatcher;
+
+    void timerCallback() override;
+    void updateRunning();
+    void renderBackground();
+
+    juce::Rectangle<float> getPlotArea() const;
+    juce::Rectangle<float> getPhaseArea (int lane) const;
+    juce::Rectangle<float> getLevelArea (int index) const;
+
+    FlangerAudioProcessor& audioProcessor;
+
+    std::array<ScopeSnapshot, SCOPEHISTORY> mHistory {};
+    int mHistoryPos;
+
+    juce::Image mBackground;
+
+    std::unique_ptr<ShowingWatcher> mShowingWatcher;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (FlangerScope)
+};
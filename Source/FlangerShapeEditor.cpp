@@ -0,0 +1,132 @@
+/*
+  ==============================================================================
+
+    FlangerShapeEditor.cpp
+
+  ==============================================================================
+*/
+
+#include "FlangerShapeEditor.h"
+
+//==============================================================================
+FlangerShapeEditor::FlangerShapeEditor (FlangerAudioProcessor& p)
+    : audioProcessor (p)
+{
+    setOpaque (true);
+
+    auto& points = audioProcessor.getUserLfoPoints();
+
+    if (points.size() == mPoints.size())
+    {
+        std::copy (points.begin(), points.end(), mPoints.begin());
+    }
+    else
+    {
+        // nothing drawn yet, and an undrawn user shape plays as sine
+        for (int i = 0; i < SHAPEEDITORPOINTS; i++)
+            mPoints[(size_t) i] = 0.5f + 0.5f * std::sin (juce::MathConstants<float>::twoPi * (float) i / (float) SHAPEEDITORPOINTS);
+    }
+}
+
+FlangerShapeEditor::~FlangerShapeEditor()
+{
+    stopTimer();
+}
+
+//==============================================================================
+juce::Rectangle<float> FlangerShapeEditor::getPlotArea() const
+{
+    return getLocalBounds().toFloat().reduced (6.0f);
+}
+
+int FlangerShapeEditor::getPointIndex (float x) const
+{
+    auto plot = getPlotArea();
+    auto index = (int) ((x - plot.getX()) * (float) SHAPEEDITORPOINTS / plot.getWidth());
+
+    return juce::jlimit (0, SHAPEEDITORPOINTS - 1, index);
+}
+
+void FlangerShapeEditor::drawTo (juce::Point<float> position)
+{
+    auto plot = getPlotArea();
+    auto first = getPointIndex (mLastPosition.x);
+    auto last = getPointIndex (position.x);
+    auto step = first <= last ? 1 : -1;
+
+    // a fast drag skips points, so fill in along the line between the two events
+    for (int i = first; ; i += step)
+    {
+        auto amount = first == last ? 1.0f : (float) (i - first) / (float) (last - first);
+        auto y = mLastPosition.y + amount * (position.y - mLastPosition.y);
+        mPoints[(size_t) i] = juce::jlimit (0.0f, 1.0f, (plot.getBottom() - y) / plot.getHeight());
+
+        if (i == last)
+            break;
+    }
+
+    mLastPosition = position;
+    repaint();
+}
+
+void FlangerShapeEditor::mouseDown (const juce::MouseEvent& e)
+{
+    stopTimer();
+    mLastPosition = e.position;
+    drawTo (e.position);
+}
+
+void FlangerShapeEditor::mouseDrag (const juce::MouseEvent& e)
+{
+    drawTo (e.position);
+}
+
+void FlangerShapeEditor::mouseUp (const juce::MouseEvent&)
+{
+    publish();
+}
+
+void FlangerShapeEditor::publish()
+{
+    if (audioProcessor.setUserLfoShape (mPoints.data(), SHAPEEDITORPOINTS))
+        stopTimer();
+    else
+        startTimer (50);
+}
+
+void FlangerShapeEditor::timerCallback()
+{
+    publish();
+}
+
+//==============================================================================
+void FlangerShapeEditor::paint (juce::Graphics& g)
+{
+    g.fillAll (juce::Colours::black);
+
+    auto plot = getPlotArea();
+    g.setColour (juce::Colours::darkgrey);
+    g.drawHorizontalLine ((int) plot.getCentreY(), plot.getX(), plot.getRight());
+    g.drawRect (plot);
+
+    g.setColour (juce::Colours::grey);
+    g.setFont (11.0f);
+    g.drawText ("User LFO (draw)", plot.reduced (4.0f), juce::Justification::topLeft);
+
+    juce::Path shape;
+    auto width = plot.getWidth() / (float) SHAPEEDITORPOINTS;
+
+    for (int i = 0; i < SHAPEEDITORPOINTS; i++)
+    {
+        auto x = plot.getX() + width * ((float) i + 0.5f);
+        auto y = plot.getBottom() - plot.getHeight() * mPoints[(size_t) i];
+
+        if (i == 0)
+            shape.startNewSubPath (x, y);
+        else
+            shape.lineTo (x, y);
+    }
+
+    g.setColour (juce::Colours::magenta);
+    g.strokePath (shape, juce::PathStrokeType (1.5f));
+}
@@ -0,0 +1,52 @@
+/*
+  ==============================================================================
+
+    FlangerShapeEditor.h
+
+    Drawing pad for the "User" LFO shape.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "PluginProcessor.h"
+
+// points across one LFO cycle; the processor resamples them to the table size
+#define SHAPEEDITORPOINTS 64
+
+//==============================================================================
+/**
+    One cycle of the user LFO shape, drawn with the mouse: dragging sets every
+    point the pointer passes over, bottom 0 to top 1. The shape is handed to the
+    processor on mouse up. The processor takes one new shape per block, so if
+    the previous one hasn't been picked up yet a short timer retries.
+*/
+class FlangerShapeEditor  : public juce::Component, private juce::Timer
+{
+public:
+    FlangerShapeEditor (FlangerAudioProcessor&);
+    ~FlangerShapeEditor() override;
+
+    void paint (juce::Graphics&) override;
+
+    void mouseDown (const juce::MouseEvent&) override;
+    void mouseDrag (const juce::MouseEvent&) override;
+    void mouseUp (const juce::MouseEvent&) override;
+
+private:
+    void timerCallback() override;
+    void drawTo (juce::Point<float> position);
+    void publish();
+
+    juce::Rectangle<float> getPlotArea() const;
+    int getPointIndex (float x) const;
+
+    FlangerAudioProcessor& audioProcessor;
+
+    std::array<float, SHAPEEDITORPOINTS> mPoints {};
+    juce::Point<float> mLastPosition;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (FlangerShapeEditor)
+};
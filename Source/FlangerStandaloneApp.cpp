@@ -0,0 +1,199 @@
+/*
+  ==============================================================================
+
+    FlangerStandaloneApp.cpp
+
+    Replaces JUCE's stock standalone application (see
+    JUCE_USE_CUSTOM_PLUGIN_STANDALONE_APP in the .jucer) so the same binary
+    can run either with the usual plugin window, or with --headless as a
+    GUI-less audio process:
+
+        Flanger --headless [--config flanger.conf] [--device dummy] [--period 64]
+
+    A build of the Tests configuration also runs the unit tests and benchmarks
+    in Source/Tests, all of them or just the one named, and exits with 1 if any
+    of them failed:
+
+        Flanger --test ["Block sizes"]
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+
+#if JucePlugin_Build_Standalone && JUCE_USE_CUSTOM_PLUGIN_STANDALONE_APP
+
+#include <juce_audio_plugin_client/Standalone/juce_StandaloneFilterWindow.h>
+#include "HeadlessHost.h"
+
+#include <csignal>
+
+#if FLANGER_UNIT_TESTS
+//==============================================================================
+/** Runs the tests off the message thread, so the ones that need timers or
+    network callbacks still get them, then quits the app.
+*/
+class FlangerTestRunner  : public juce::Thread
+{
+public:
+    explicit FlangerTestRunner (const juce::String& name)
+        : juce::Thread ("Flanger tests"), testName (name)
+    {
+    }
+
+    ~FlangerTestRunner() override
+    {
+        stopThread (60000);
+    }
+
+    void run() override
+    {
+        juce::UnitTestRunner runner;
+        runner.setAssertOnFailure (false);
+
+        juce::Array<juce::UnitTest*> tests;
+
+        for (auto* test : juce::UnitTest::getTestsInCategory ("Flanger"))
+            if (testName.isEmpty() || test->getName().equalsIgnoreCase (testName))
+                tests.add (test);
+
+        runner.runTests (tests);
+
+        // a name that matched nothing counts as a failure
+        auto failed = tests.isEmpty();
+
+        for (int i = 0; i < runner.getNumResults(); i++)
+            failed = failed || runner.getResult (i)->failures > 0;
+
+        juce::MessageManager::callAsync ([failed]
+        {
+            if (auto* app = juce::JUCEApplicationBase::getInstance())
+                app->setApplicationReturnValue (failed ? 1 : 0);
+
+            juce::JUCEApplicationBase::quit();
+        });
+    }
+
+private:
+    const juce::String testName;
+};
+#endif
+
+//==============================================================================
+class FlangerStandaloneApp  : public juce::JUCEApplication,
+                              private juce::Timer
+{
+public:
+    FlangerStandaloneApp()
+    {
+        juce::PropertiesFile::Options options;
+        options.applicationName     = JucePlugin_Name;
+        options.filenameSuffix      = ".settings";
+        options.osxLibrarySubFolder = "Application Support";
+        options.folderName          = "";
+
+        mAppProperties.setStorageParameters (options);
+    }
+
+    const juce::String getApplicationName() override    { return JucePlugin_Name; }
+    const juce::String getApplicationVersion() override { return JucePlugin_VersionString; }
+    bool moreThanOneInstanceAllowed() override          { return true; }
+    void anotherInstanceStarted (const juce::String&) override {}
+
+    void initialise (const juce::String&) override
+    {
+        auto args = getCommandLineParameterArray();
+
+       #if FLANGER_UNIT_TESTS
+        if (args.contains ("--test"))
+        {
+            auto name = args[args.indexOf ("--test") + 1];
+
+            mTestRunner = std::make_unique<FlangerTestRunner> (name.startsWith ("--") ? juce::String() : name.unquoted());
+            mTestRunner->startThread();
+            return;
+        }
+       #endif
+
+        if (args.contains ("--headless"))
+        {
+            HeadlessConfig config;
+
+            if (! config.parseCommandLine (args))
+            {
+                juce::Logger::writeToLog ("Usage: " + getApplicationName() + " --headless [--config file] [--<key> <value> ...]");
+                setApplicationReturnValue (2);
+                quit();
+                return;
+            }
+
+            mHeadlessHost = std::make_unique<HeadlessHost> (config);
+            auto error = mHeadlessHost->start();
+
+            if (error.isNotEmpty())
+            {
+                juce::Logger::writeToLog ("Could not start: " + error);
+                setApplicationReturnValue (1);
+                quit();
+                return;
+            }
+
+            // JUCE doesn't turn SIGINT / SIGTERM into a quit without a window, so poll a flag
+            std::signal (SIGINT, handleSignal);
+            std::signal (SIGTERM, handleSignal);
+            startTimer (100);
+            return;
+        }
+
+        mMainWindow.reset (new juce::StandaloneFilterWindow (getApplicationName(),
+                                                             juce::LookAndFeel::getDefaultLookAndFeel().findColour (juce::ResizableWindow::backgroundColourId),
+                                                             mAppProperties.getUserSettings(),
+                                                             false));
+        mMainWindow->setVisible (true);
+    }
+
+    void shutdown() override
+    {
+        stopTimer();
+       #if FLANGER_UNIT_TESTS
+        mTestRunner.reset();
+       #endif
+        mHeadlessHost.reset();
+        mMainWindow.reset();
+    }
+
+    void systemRequestedQuit() override
+    {
+        if (mMainWindow != nullptr)
+            mMainWindow->pluginHolder->savePluginState();
+
+        quit();
+    }
+
+private:
+    static void handleSignal (int)
+    {
+        sQuitRequested = 1;
+    }
+
+    void timerCallback() override
+    {
+        if (sQuitRequested != 0)
+            systemRequestedQuit();
+    }
+
+    static volatile std::sig_atomic_t sQuitRequested;
+
+    juce::ApplicationProperties mAppProperties;
+    std::unique_ptr<juce::StandaloneFilterWindow> mMainWindow;
+    std::unique_ptr<HeadlessHost> mHeadlessHost;
+   #if FLANGER_UNIT_TESTS
+    std::unique_ptr<FlangerTestRunner> mTestRunner;
+   #endif
+};
+
+volatile std::sig_atomic_t FlangerStandaloneApp::sQuitRequested = 0;
+
+JUCE_CREATE_APPLICATION_DEFINE (FlangerStandaloneApp)
+
+#endif
@@ -0,0 +1,49 @@
+/*
+  ==============================================================================
+
+    GovernorMonitor.cpp
+
+  ==============================================================================
+*/
+
+#include "GovernorMonitor.h"
+
+//==============================================================================
+GovernorMonitor::GovernorMonitor()
+{
+}
+
+GovernorMonitor::~GovernorMonitor()
+{
+    stopTimer();
+    jassert (mClients.isEmpty());
+}
+
+void GovernorMonitor::addClient (Client* client)
+{
+    const juce::ScopedLock lock (mLock);
+
+    mClients.addIfNotAlreadyThere (client);
+
+    if (! isTimerRunning())
+        startTimerHz (GOVERNORMONITORHZ);
+}
+
+void GovernorMonitor::removeClient (Client* client)
+{
+    // taking the lock also waits out a timer callback that is calling this client
+    const juce::ScopedLock lock (mLock);
+
+    mClients.removeFirstMatchingValue (client);
+
+    if (mClients.isEmpty())
+        stopTimer();
+}
+
+void GovernorMonitor::timerCallback()
+{
+    const juce::ScopedLock lock (mLock);
+
+    for (auto* client : mClients)
+        client->logGovernorTier();
+}
@@ -0,0 +1,56 @@
+/*
+  ==============================================================================
+
+    GovernorMonitor.h
+
+    Message-thread logging of CPU governor tier changes.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// how often the registered instances' published tiers are looked at
+#define GOVERNORMONITORHZ 4
+
+//==============================================================================
+/**
+    One timer shared by every instance in the process. Hold it through a
+    juce::SharedResourcePointer<GovernorMonitor>.
+
+    The governor runs on the audio thread and only publishes its tier, since
+    logging from there would take locks and allocate. A client registers
+    while prepared; the timer asks each one to compare its published tier with
+    the last one it logged. That way tier changes are logged whether or not an
+    editor is open. The timer only runs while someone is registered.
+*/
+class GovernorMonitor  : private juce::Timer
+{
+public:
+    struct Client
+    {
+        virtual ~Client() = default;
+
+        /** Called on the message thread. Logs the tier if it changed since the last call. */
+        virtual void logGovernorTier() = 0;
+    };
+
+    GovernorMonitor();
+    ~GovernorMonitor() override;
+
+    /** Not from the audio thread. Registering twice is harmless. */
+    void addClient (Client* client);
+
+    /** Not from the audio thread. Once this returns the client won't be called again. */
+    void removeClient (Client* client);
+
+private:
+    void timerCallback() override;
+
+    juce::CriticalSection mLock;
+    juce::Array<Client*> mClients;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (GovernorMonitor)
+};
@@ -0,0 +1,530 @@
+/*
+  ==============================================================================
+
+    HeadlessHost.cpp
+
+  ==============================================================================
+*/
+
+#include "HeadlessHost.h"
+
+#if JUCE_LINUX
+ #include <sys/mman.h>
+ #include <pthread.h>
+ #include <sched.h>
+#endif
+
+#include <poll.h>
+#include <unistd.h>
+#include <cerrno>
+
+//==============================================================================
+static bool splitSetting (const juce::String& line, juce::String& key, juce::String& value)
+{
+    auto text = line.upToFirstOccurrenceOf ("#", false, false).trim();
+
+    if (text.isEmpty())
+        return false;
+
+    key = text.initialSectionNotContaining ("= \t").toLowerCase();
+    value = text.substring (key.length()).trimCharactersAtStart ("= \t").trim();
+    return true;
+}
+
+bool HeadlessConfig::parseLine (const juce::String& line)
+{
+    juce::String key, value;
+
+    if (! splitSetting (line, key, value))
+        return true;
+
+    if (key == "device")
+    {
+        deviceType = value.upToFirstOccurrenceOf (":", false, false).toLowerCase();
+        deviceName = value.fromFirstOccurrenceOf (":", false, false);
+        return deviceType == "alsa" || deviceType == "dummy";
+    }
+
+    if (key == "samplerate")
+    {
+        sampleRate = value.getDoubleValue();
+        return sampleRate > 0.0;
+    }
+
+    if (key == "period")
+    {
+        periodSize = value.getIntValue();
+        return periodSize > 0;
+    }
+
+    if (key == "oscport")
+    {
+        oscPort = value.getIntValue();
+        return oscPort >= 0 && oscPort <= 65535;
+    }
+
+    if (key == "oscbind")
+    {
+        oscBindAddress = value;
+        return true;
+    }
+
+    if (key == "log")
+    {
+        logIntervalSeconds = value.getIntValue();
+        return logIntervalSeconds >= 0;
+    }
+
+    // checked against the processor's settings once the host exists, see HeadlessHost::start
+    parameterLines.add (line);
+    return true;
+}
+
+bool HeadlessConfig::loadFile (const juce::File& file)
+{
+    if (! file.existsAsFile())
+    {
+        juce::Logger::writeToLog ("Config file not found: " + file.getFullPathName());
+        return false;
+    }
+
+    juce::StringArray lines;
+    file.readLines (lines);
+
+    for (auto& line : lines)
+    {
+        if (! parseLine (line))
+        {
+            juce::Logger::writeToLog ("Bad line in " + file.getFileName() + ": " + line);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool HeadlessConfig::parseCommandLine (const juce::StringArray& args)
+{
+    for (int i = 0; i < args.size(); i++)
+    {
+        auto option = args[i];
+
+        if (! option.startsWith ("--") || option == "--headless")
+            continue;
+
+        if (i + 1 >= args.size())
+        {
+            juce::Logger::writeToLog ("No value given for " + option);
+            return false;
+        }
+
+        auto value = args[++i].unquoted();
+
+        if (option == "--config")
+        {
+            if (! loadFile (juce::File::getCurrentWorkingDirectory().getChildFile (value)))
+                return false;
+        }
+        else if (! parseLine (option.substring (2) + " " + value))
+        {
+            juce::Logger::writeToLog ("Bad option: " + option + " " + value);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+//==============================================================================
+/** Stand-in for a sound card: ticks at the period rate on a real-time thread.
+
+    The input is a second of noise played on a loop. Silence would never get the
+    delay line allocated, so only the dry path would run and the timings would
+    say nothing about the flanger.
+*/
+class HeadlessHost::DummyDevice  : public juce::Thread
+{
+public:
+    DummyDevice (HeadlessHost& h, double rate, int period)
+        : juce::Thread ("Flanger dummy device"), host (h), sampleRate (rate), periodSize (period)
+    {
+    }
+
+    ~DummyDevice() override
+    {
+        stopThread (1000);
+    }
+
+    void run() override
+    {
+       #if JUCE_LINUX
+        sched_param param;
+        param.sched_priority = sched_get_priority_max (SCHED_FIFO) - 1;
+
+        if (pthread_setschedparam (pthread_self(), SCHED_FIFO, &param) != 0)
+            juce::Logger::writeToLog ("Dummy device: no permission for SCHED_FIFO, running at normal priority");
+       #endif
+
+        juce::AudioBuffer<float> input (2, periodSize), output (2, periodSize);
+        juce::AudioBuffer<float> signal (2, (int) sampleRate);
+        juce::Random random;
+
+        // -12 dBFS, well clear of clipping once the feedback builds up
+        for (int channel = 0; channel < 2; channel++)
+            for (int i = 0; i < signal.getNumSamples(); i++)
+                signal.setSample (channel, i, 0.25f * (2.0f * random.nextFloat() - 1.0f));
+
+        int signalPos = 0;
+
+        const double periodMs = 1000.0 * periodSize / sampleRate;
+        auto deadline = juce::Time::getMillisecondCounterHiRes() + periodMs;
+
+        while (! threadShouldExit())
+        {
+            for (int done = 0; done < periodSize;)
+            {
+                auto numToCopy = juce::jmin (periodSize - done, signal.getNumSamples() - signalPos);
+
+                for (int channel = 0; channel < 2; channel++)
+                    input.copyFrom (channel, done, signal, channel, signalPos, numToCopy);
+
+                done += numToCopy;
+                signalPos = (signalPos + numToCopy) % signal.getNumSamples();
+            }
+
+            host.processPeriod (input.getArrayOfReadPointers(), 2,
+                                output.getArrayOfWritePointers(), 2, periodSize);
+
+            auto now = juce::Time::getMillisecondCounterHiRes();
+
+            if (now > deadline)
+            {
+                // missed the slot a real device would have played: count it and resync
+                host.mDummyXrunCount++;
+                deadline = now;
+            }
+            else
+            {
+                while (juce::Time::getMillisecondCounterHiRes() < deadline && ! threadShouldExit())
+                    juce::Thread::sleep (juce::jmax (0, (int) (deadline - juce::Time::getMillisecondCounterHiRes()) - 1));
+            }
+
+            deadline += periodMs;
+        }
+    }
+
+private:
+    HeadlessHost& host;
+    const double sampleRate;
+    const int periodSize;
+};
+
+//==============================================================================
+/** Reads parameter lines from stdin for as long as it stays open.
+
+    A blocking read can't be interrupted, so stdin is polled with a short
+    timeout and the thread checks threadShouldExit() in between. That lets
+    stop() join it even when stdin is a terminal or a pipe nobody writes to.
+*/
+class HeadlessHost::StdinReader  : public juce::Thread
+{
+public:
+    StdinReader (HeadlessHost& h)
+        : juce::Thread ("Flanger stdin"), host (h)
+    {
+    }
+
+    ~StdinReader() override
+    {
+        stopThread (1000);
+    }
+
+    void run() override
+    {
+        std::string pending;
+        char chunk[256];
+
+        while (! threadShouldExit())
+        {
+            pollfd input { STDIN_FILENO, POLLIN, 0 };
+            auto ready = poll (&input, 1, 100);
+
+            if (ready < 0 && errno != EINTR)
+                return;
+
+            if (ready <= 0)
+                continue;
+
+            auto numRead = read (STDIN_FILENO, chunk, sizeof (chunk));
+
+            // closed (or a hang-up with nothing left to read)
+            if (numRead == 0 || (numRead < 0 && errno != EINTR && errno != EAGAIN))
+                return;
+
+            if (numRead < 0)
+                continue;
+
+            pending.append (chunk, (size_t) numRead);
+
+            for (auto newline = pending.find ('\n'); newline != std::string::npos; newline = pending.find ('\n'))
+            {
+                juce::String text (pending.substr (0, newline));
+                pending.erase (0, newline + 1);
+
+                if (text.trim() == "quit")
+                {
+                    juce::MessageManager::callAsync ([] { juce::JUCEApplicationBase::quit(); });
+                    return;
+                }
+
+                if (! host.applySetting (text))
+                    juce::Logger::writeToLog ("Ignored: " + text);
+            }
+        }
+    }
+
+private:
+    HeadlessHost& host;
+};
+
+//==============================================================================
+HeadlessHost::HeadlessHost (const HeadlessConfig& config)
+    : mConfig (config), mPeriodMicros (0.0)
+{
+    mProcessor.reset (new FlangerAudioProcessor());
+}
+
+HeadlessHost::~HeadlessHost()
+{
+    stop();
+}
+
+void HeadlessHost::lockMemory()
+{
+   #if JUCE_LINUX
+    // keep the delay line and tables from being paged out mid-callback
+    if (mlockall (MCL_CURRENT | MCL_FUTURE) != 0)
+        juce::Logger::writeToLog ("mlockall failed (check RLIMIT_MEMLOCK), continuing without locked memory");
+   #endif
+}
+
+juce::String HeadlessHost::start()
+{
+    lockMemory();
+
+    if (mConfig.oscPort > 0 && ! mProcessor->startOscControl (mConfig.oscPort, mConfig.oscBindAddress))
+        juce::Logger::writeToLog ("Could not open OSC port " + mConfig.oscBindAddress + ":" + juce::String (mConfig.oscPort));
+
+    if (mConfig.deviceType == "dummy")
+    {
+        prepare (mConfig.sampleRate, mConfig.periodSize);
+
+        for (auto& line : mConfig.parameterLines)
+            if (! applySetting (line))
+                return "Unknown setting: " + line;
+
+        mDummyDevice = std::make_unique<DummyDevice> (*this, mConfig.sampleRate, mConfig.periodSize);
+        mDummyDevice->startThread (10);
+    }
+    else
+    {
+        mDeviceManager.setCurrentAudioDeviceType ("ALSA", true);
+
+        juce::AudioDeviceManager::AudioDeviceSetup setup;
+        mDeviceManager.getAudioDeviceSetup (setup);
+        setup.sampleRate = mConfig.sampleRate;
+        setup.bufferSize = mConfig.periodSize;
+
+        if (mConfig.deviceName.isNotEmpty())
+        {
+            setup.inputDeviceName = mConfig.deviceName;
+            setup.outputDeviceName = mConfig.deviceName;
+        }
+
+        auto error = mDeviceManager.initialise (2, 2, nullptr, false, mConfig.deviceName, &setup);
+
+        if (error.isNotEmpty())
+            return error;
+
+        // replayed before the callback starts, so they land in the first block
+        for (auto& line : mConfig.parameterLines)
+            if (! applySetting (line))
+                return "Unknown setting: " + line;
+
+        mDeviceManager.addAudioCallback (this);
+    }
+
+    mStdinReader = std::make_unique<StdinReader> (*this);
+    mStdinReader->startThread();
+
+    if (mConfig.logIntervalSeconds > 0)
+        startTimer (mConfig.logIntervalSeconds * 1000);
+
+    return {};
+}
+
+void HeadlessHost::stop()
+{
+    stopTimer();
+
+    // the reader polls, so this returns within one poll timeout
+    if (mStdinReader != nullptr)
+        mStdinReader->stopThread (1000);
+
+    mStdinReader.reset();
+
+    mDummyDevice.reset();
+    mDeviceManager.removeAudioCallback (this);
+    mDeviceManager.closeAudioDevice();
+    mProcessor->stopOscControl();
+}
+
+bool HeadlessHost::applySetting (const juce::String& line)
+{
+    juce::String key, value;
+
+    if (! splitSetting (line, key, value))
+        return true;
+
+    if (key == "eco")
+    {
+        mProcessor->setEcoMode (value.getIntValue() != 0);
+        return true;
+    }
+
+    if (key == "cubic")
+    {
+        mProcessor->setCubicInterpolation (value.getIntValue() != 0);
+        return true;
+    }
+
+    // emulates a slower machine, to see the governor step down and count the overruns
+    if (key == "load")
+    {
+        mProcessor->setInjectedLoad (value.getFloatValue());
+        return true;
+    }
+
+    FlangerCommand command;
+    command.value = value.getFloatValue();
+
+    if (key == "frequency")
+        command.type = FlangerCommand::frequency;
+    else if (key == "depth")
+        command.type = FlangerCommand::depth;
+    else if (key == "feedback")
+        command.type = FlangerCommand::feedback;
+    else if (key == "lfotype")
+        command.type = FlangerCommand::lfoType;
+    else if (key == "motion")
+        command.type = FlangerCommand::motion;
+    else if (key == "morph")
+        command.type = FlangerCommand::morph;
+    else if (key == "clear")
+        command.type = FlangerCommand::clear;
+    else if (key == "scdepth")
+        command.type = FlangerCommand::sidechainDepth;
+    else if (key == "scdelay")
+        command.type = FlangerCommand::sidechainDelay;
+    else if (key == "budget")
+        command.type = FlangerCommand::cpuBudget;
+    else
+        return false;
+
+    return mProcessor->pushCommand (command);
+}
+
+//==============================================================================
+void HeadlessHost::prepare (double sampleRate, int maxPeriodSize)
+{
+    mPeriodMicros = 1.0e6 * maxPeriodSize / sampleRate;
+    mBuffer.setSize (2, maxPeriodSize);
+
+    mProcessor->setPlayConfigDetails (2, 2, sampleRate, maxPeriodSize);
+    mProcessor->prepareToPlay (sampleRate, maxPeriodSize);
+}
+
+void HeadlessHost::processPeriod (const float** inputChannelData, int numInputChannels,
+                                  float** outputChannelData, int numOutputChannels, int numSamples)
+{
+    auto startTicks = juce::Time::getHighResolutionTicks();
+
+    // a device period longer than prepared for is split rather than reallocated
+    for (int start = 0; start < numSamples; start += mBuffer.getNumSamples())
+    {
+        auto n = juce::jmin (mBuffer.getNumSamples(), numSamples - start);
+        juce::AudioBuffer<float> block (mBuffer.getArrayOfWritePointers(), 2, n);
+
+        for (int channel = 0; channel < 2; channel++)
+        {
+            // a mono input feeds both lanes
+            if (numInputChannels > 0)
+                block.copyFrom (channel, 0, inputChannelData[juce::jmin (channel, numInputChannels - 1)] + start, n);
+            else
+                block.clear (channel, 0, n);
+        }
+
+        mProcessor->processBlock (block, mMidi);
+
+        for (int channel = 0; channel < numOutputChannels; channel++)
+            juce::FloatVectorOperations::copy (outputChannelData[channel] + start,
+                                               block.getReadPointer (juce::jmin (channel, 1)), n);
+    }
+
+    auto micros = (juce::int64) (1.0e6 * juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - startTicks));
+
+    mCallbackCount++;
+    mTotalMicros += micros;
+
+    if (micros > mWorstMicros.load())
+        mWorstMicros = micros;
+
+    if ((double) micros > mPeriodMicros)
+        mOverrunCount++;
+}
+
+void HeadlessHost::audioDeviceIOCallback (const float** inputChannelData, int numInputChannels,
+                                          float** outputChannelData, int numOutputChannels, int numSamples)
+{
+    processPeriod (inputChannelData, numInputChannels, outputChannelData, numOutputChannels, numSamples);
+}
+
+void HeadlessHost::audioDeviceAboutToStart (juce::AudioIODevice* device)
+{
+    juce::Logger::writeToLog ("Opened " + device->getName() + " at " + juce::String (device->getCurrentSampleRate())
+                              + " Hz, period " + juce::String (device->getCurrentBufferSizeSamples())
+                              + ", latency in/out " + juce::String (device->getInputLatencyInSamples())
+                              + "/" + juce::String (device->getOutputLatencyInSamples()) + " samples");
+
+    prepare (device->getCurrentSampleRate(), device->getCurrentBufferSizeSamples());
+}
+
+void HeadlessHost::audioDeviceStopped()
+{
+    mProcessor->releaseResources();
+}
+
+void HeadlessHost::timerCallback()
+{
+    auto callbacks = mCallbackCount.exchange (0);
+    auto totalMicros = mTotalMicros.exchange (0);
+    auto worstMicros = mWorstMicros.exchange (0);
+    auto overruns = mOverrunCount.exchange (0);
+
+    int xruns = mDummyXrunCount.load();
+
+    if (auto* device = mDeviceManager.getCurrentAudioDevice())
+        xruns = device->getXRunCount();
+
+    auto tier = mProcessor->getGovernorTier();
+
+    juce::Logger::writeToLog ("callbacks " + juce::String (callbacks)
+                              + ", mean " + juce::String (callbacks > 0 ? (double) totalMicros / callbacks : 0.0, 1) + " us"
+                              + ", worst " + juce::String (worstMicros) + " us"
+                              + " of " + juce::String (mPeriodMicros, 1) + " us"
+                              + ", overruns " + juce::String (overruns)
+                              + ", xruns since start " + juce::String (xruns)
+                              + ", commands " + juce::String (mProcessor->getNumCommandsApplied())
+                              + " (" + juce::String (mProcessor->getNumCommandsDropped()) + " dropped)"
+                              + ", tier " + FlangerAudioProcessor::getGovernorTierName (tier));
+}
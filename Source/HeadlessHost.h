@@ -0,0 +1,114 @@
+/*
+  ==============================================================================
+
+    HeadlessHost.h
+
+    GUI-less host for running the flanger as a dedicated audio process on a
+    Linux box without a display server. Started by the standalone app when it
+    is given --headless.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "PluginProcessor.h"
+
+//==============================================================================
+/**
+    Startup settings, read from a config file and then overridden from the
+    command line. The file holds one "key = value" per line, '#' starts a
+    comment, and any parameter key (see HeadlessHost::applySetting) may appear
+    there as well as on stdin.
+
+        device      alsa[:name] or dummy      (default alsa, the default device)
+        samplerate  Hz                        (48000)
+        period      samples per callback      (64)
+        oscport     UDP port for OSC control  (off)
+        oscbind     interface OSC listens on  (127.0.0.1, 0.0.0.0 for all)
+        log         seconds between reports   (5)
+*/
+struct HeadlessConfig
+{
+    juce::String deviceType = "alsa";
+    juce::String deviceName;
+    double sampleRate = 48000.0;
+    int periodSize = 64;
+    int oscPort = 0;
+    juce::String oscBindAddress = "127.0.0.1";
+    int logIntervalSeconds = 5;
+
+    // parameter lines are replayed into the host once the processor exists
+    juce::StringArray parameterLines;
+
+    /** Each returns false, having logged why, on a value the host can't run with. */
+    bool parseLine (const juce::String& line);
+    bool loadFile (const juce::File& file);
+    bool parseCommandLine (const juce::StringArray& args);
+};
+
+//==============================================================================
+/**
+    Owns the processor and drives it from either an ALSA device (through
+    juce::AudioDeviceManager) or a dummy device, a real-time thread that ticks
+    at the period rate with looped noise as input and discards the output. The
+    dummy device is for testing on machines without a sound card.
+
+    Per callback it records the processing time. A message-thread timer then
+    logs the callback count, mean and worst time against the period budget,
+    overruns, the device's xrun count, the remote commands applied and dropped,
+    and the CPU governor's tier.
+*/
+class HeadlessHost  : private juce::AudioIODeviceCallback,
+                      private juce::Timer
+{
+public:
+    explicit HeadlessHost (const HeadlessConfig&);
+    ~HeadlessHost() override;
+
+    /** Locks memory, opens the device and starts processing. Returns an error message, or empty on success. */
+    juce::String start();
+    void stop();
+
+    /** Parses "key value" or "key = value" and applies it: frequency, depth, feedback,
+        lfotype, motion, morph, clear, scdepth, scdelay, budget, eco, cubic, and load (injected
+        CPU load for stress runs, see FlangerAudioProcessor::setInjectedLoad). Safe from any thread. */
+    bool applySetting (const juce::String& line);
+
+private:
+    class DummyDevice;
+    class StdinReader;
+
+    //==============================================================================
+    void audioDeviceIOCallback (const float** inputChannelData, int numInputChannels,
+                                float** outputChannelData, int numOutputChannels, int numSamples) override;
+    void audioDeviceAboutToStart (juce::AudioIODevice* device) override;
+    void audioDeviceStopped() override;
+
+    void timerCallback() override;
+
+    void prepare (double sampleRate, int maxPeriodSize);
+    void processPeriod (const float** inputChannelData, int numInputChannels,
+                        float** outputChannelData, int numOutputChannels, int numSamples);
+    static void lockMemory();
+
+    HeadlessConfig mConfig;
+    std::unique_ptr<FlangerAudioProcessor> mProcessor;
+    juce::AudioDeviceManager mDeviceManager;
+    std::unique_ptr<DummyDevice> mDummyDevice;
+    std::unique_ptr<StdinReader> mStdinReader;
+
+    juce::AudioBuffer<float> mBuffer;
+    juce::MidiBuffer mMidi;
+    double mPeriodMicros;
+
+    // written by the audio thread, read and reset by the log timer
+    std::atomic<int> mCallbackCount { 0 };
+    std::atomic<int> mOverrunCount { 0 };
+    std::atomic<int> mDummyXrunCount { 0 };
+    std::atomic<juce::int64> mTotalMicros { 0 };
+    std::atomic<juce::int64> mWorstMicros { 0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (HeadlessHost)
+};
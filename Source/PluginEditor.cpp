@@ -11,42 +11,102 @@
 
 //==============================================================================
 FlangerAudioProcessorEditor::FlangerAudioProcessorEditor (FlangerAudioProcessor& p)
-    : AudioProcessorEditor (&p), audioProcessor (p)
+    : AudioProcessorEditor (&p), audioProcessor (p), mScope (p), mShapeEditor (p)
 {
     // Make sure that before the constructor has finished, you've set the
     // editor's size to whatever you need it to be.
-    setSize (700, 500);
+    setSize (700, 600);
     
     mLfoFrequencySlider.setSliderStyle(juce::Slider::LinearHorizontal);
     mLfoFrequencySlider.setRange(0.0f, 3.0f, 0.01f);
-    mLfoFrequencySlider.setValue(audioProcessor.mLfoFreqSliderValue);
+    // the initial values only mirror the processor, so they don't notify and push commands
+    mLfoFrequencySlider.setValue(audioProcessor.mLfoFreqSliderValue, juce::dontSendNotification);
     addAndMakeVisible(&mLfoFrequencySlider);
     mLfoFrequencySlider.addListener(this);
     
     mFeedbackSlider.setSliderStyle(juce::Slider::LinearHorizontal);
     mFeedbackSlider.setRange(0.0f, 99.0f);
-    mFeedbackSlider.setValue(audioProcessor.mFeedbackGain * 100.0f);
+    mFeedbackSlider.setValue(audioProcessor.mFeedbackGain * 100.0f, juce::dontSendNotification);
     addAndMakeVisible(&mFeedbackSlider);
     mFeedbackSlider.addListener(this);
         
     mLfoDepthSlider.setSliderStyle(juce::Slider::LinearHorizontal);
     mLfoDepthSlider.setRange(0.0f, 100.0f, 1.0f);
-    mLfoDepthSlider.setValue(audioProcessor.getDepthTarget() * 100.0f);
+    mLfoDepthSlider.setValue(audioProcessor.getDepthTarget() * 100.0f, juce::dontSendNotification);
     addAndMakeVisible(&mLfoDepthSlider);
     mLfoDepthSlider.addListener(this);
     
-    mLfoTypeBox.addItem("Sine", 1);
-    mLfoTypeBox.addItem("Saw", 2);
-    mLfoTypeBox.setSelectedId(audioProcessor.mLfoFlag);
+    mLfoMorphSlider.setSliderStyle(juce::Slider::LinearHorizontal);
+    mLfoMorphSlider.setRange(0.0f, userShape - sine, 0.01f);
+    // only mirrors the processor; a notification would push the value straight back
+    mLfoMorphSlider.setValue(audioProcessor.getLfoMorph(), juce::dontSendNotification);
+    addAndMakeVisible(&mLfoMorphSlider);
+    mLfoMorphSlider.addListener(this);
+    
+    mSidechainDepthSlider.setSliderStyle(juce::Slider::RotaryHorizontalVerticalDrag);
+    mSidechainDepthSlider.setTextBoxStyle(juce::Slider::NoTextBox, false, 0, 0);
+    mSidechainDepthSlider.setRange(0.0f, 100.0f, 1.0f);
+    mSidechainDepthSlider.setValue(audioProcessor.getSidechainDepthAmount() * 100.0f);
+    addAndMakeVisible(&mSidechainDepthSlider);
+    mSidechainDepthSlider.addListener(this);
+    
+    mSidechainDelaySlider.setSliderStyle(juce::Slider::RotaryHorizontalVerticalDrag);
+    mSidechainDelaySlider.setTextBoxStyle(juce::Slider::NoTextBox, false, 0, 0);
+    mSidechainDelaySlider.setRange(0.0f, 100.0f, 1.0f);
+    mSidechainDelaySlider.setValue(audioProcessor.getSidechainDelayAmount() * 100.0f);
+    addAndMakeVisible(&mSidechainDelaySlider);
+    mSidechainDelaySlider.addListener(this);
+    
+    mLfoTypeBox.addItem("Sine", sine);
+    mLfoTypeBox.addItem("Saw", saw);
+    mLfoTypeBox.addItem("Triangle", triangle);
+    mLfoTypeBox.addItem("Square", square);
+    mLfoTypeBox.addItem("Exp", exponential);
+    mLfoTypeBox.addItem("Random", smoothRandom);
+    mLfoTypeBox.addItem("User", userShape);
+    // a notification would push an lfoType command and snap a fractional morph to the shape
+    mLfoTypeBox.setSelectedId(audioProcessor.mLfoType, juce::dontSendNotification);
     addAndMakeVisible(&mLfoTypeBox);
     mLfoTypeBox.addListener(this);
     
     mLfoContraryMotionTypeBox.addItem("Contrary", 1);
     mLfoContraryMotionTypeBox.addItem("Sync", 2);
-    mLfoContraryMotionTypeBox.setSelectedId(audioProcessor.mContraryMotionFlag);
+    mLfoContraryMotionTypeBox.setSelectedId(audioProcessor.mContraryMotionFlag ? contrary : sync, juce::dontSendNotification);
     addAndMakeVisible(&mLfoContraryMotionTypeBox);
     mLfoContraryMotionTypeBox.addListener(this);
     
+    mEcoModeButton.setButtonText("Eco");
+    mEcoModeButton.setToggleState(audioProcessor.getEcoMode(), juce::dontSendNotification);
+    addAndMakeVisible(&mEcoModeButton);
+    mEcoModeButton.addListener(this);
+    
+    mCubicButton.setButtonText("Cubic");
+    mCubicButton.setToggleState(audioProcessor.getCubicInterpolation(), juce::dontSendNotification);
+    addAndMakeVisible(&mCubicButton);
+    mCubicButton.addListener(this);
+    
+    addAndMakeVisible(&mScope);
+    
+    addAndMakeVisible(&mShapeEditor);
+    
+    mGovernorLabel.setColour(juce::Label::textColourId, juce::Colours::magenta);
+    addAndMakeVisible(&mGovernorLabel);
+    startTimerHz(4);
+    
+    mClearBufButton.setButtonText("Clear");
+    addAndMakeVisible(&mClearBufButton);
+    mClearBufButton.addListener(this);
+    
+    mOscPortEditor.setEditable(true);
+    mOscPortEditor.setText(audioProcessor.getOscPort() > 0 ? juce::String(audioProcessor.getOscPort()) : "Off", juce::dontSendNotification);
+    addAndMakeVisible(&mOscPortEditor);
+    mOscPortEditor.addListener(this);
+    
+    mOscBindEditor.setEditable(true);
+    mOscBindEditor.setText(audioProcessor.getOscBindAddress(), juce::dontSendNotification);
+    addAndMakeVisible(&mOscBindEditor);
+    mOscBindEditor.addListener(this);
+    
     addAndMakeVisible(&mLfoFrequencyLabel);
     mLfoFrequencyLabel.setText("Frequency", juce::dontSendNotification);
     mLfoFrequencyLabel.attachToComponent(&mLfoFrequencySlider, true);
@@ -65,6 +125,24 @@ FlangerAudioProcessorEditor::FlangerAudioProcessorEditor (FlangerAudioProcessor&
     mLfoDepthLabel.setColour(juce::Label::textColourId, juce::Colours::magenta);
     mLfoDepthLabel.setJustificationType(juce::Justification::right);
     
+    addAndMakeVisible(&mLfoMorphLabel);
+    mLfoMorphLabel.setText("Morph", juce::dontSendNotification);
+    mLfoMorphLabel.attachToComponent(&mLfoMorphSlider, true);
+    mLfoMorphLabel.setColour(juce::Label::textColourId, juce::Colours::magenta);
+    mLfoMorphLabel.setJustificationType(juce::Justification::right);
+    
+    addAndMakeVisible(&mSidechainDepthLabel);
+    mSidechainDepthLabel.setText("SC Depth", juce::dontSendNotification);
+    mSidechainDepthLabel.attachToComponent(&mSidechainDepthSlider, false);
+    mSidechainDepthLabel.setColour(juce::Label::textColourId, juce::Colours::magenta);
+    mSidechainDepthLabel.setJustificationType(juce::Justification::centred);
+    
+    addAndMakeVisible(&mSidechainDelayLabel);
+    mSidechainDelayLabel.setText("SC Delay", juce::dontSendNotification);
+    mSidechainDelayLabel.attachToComponent(&mSidechainDelaySlider, false);
+    mSidechainDelayLabel.setColour(juce::Label::textColourId, juce::Colours::magenta);
+    mSidechainDelayLabel.setJustificationType(juce::Justification::centred);
+    
     addAndMakeVisible(&mLfoTypeLabel);
     mLfoTypeLabel.setText("LFO Type", juce::dontSendNotification);
     mLfoTypeLabel.attachToComponent(&mLfoTypeBox, true);
@@ -76,60 +154,124 @@ FlangerAudioProcessorEditor::FlangerAudioProcessorEditor (FlangerAudioProcessor&
     mLfoContraryMotionTypeLabel.attachToComponent(&mLfoContraryMotionTypeBox, true);
     mLfoContraryMotionTypeLabel.setColour(juce::Label::textColourId, juce::Colours::magenta);
     mLfoContraryMotionTypeLabel.setJustificationType(juce::Justification::right);
+    
+    addAndMakeVisible(&mOscPortLabel);
+    mOscPortLabel.setText("OSC Port", juce::dontSendNotification);
+    mOscPortLabel.attachToComponent(&mOscPortEditor, true);
+    mOscPortLabel.setColour(juce::Label::textColourId, juce::Colours::magenta);
+    mOscPortLabel.setJustificationType(juce::Justification::right);
+    
+    addAndMakeVisible(&mOscBindLabel);
+    mOscBindLabel.setText("Bind", juce::dontSendNotification);
+    mOscBindLabel.attachToComponent(&mOscBindEditor, true);
+    mOscBindLabel.setColour(juce::Label::textColourId, juce::Colours::magenta);
+    mOscBindLabel.setJustificationType(juce::Justification::right);
 }
 
 FlangerAudioProcessorEditor::~FlangerAudioProcessorEditor()
 {
+    stopTimer();
     mLfoFrequencySlider.removeListener(this);
     mFeedbackSlider.removeListener(this);
     mLfoDepthSlider.removeListener(this);
     mLfoTypeBox.removeListener(this);
+    mLfoMorphSlider.removeListener(this);
+    mSidechainDepthSlider.removeListener(this);
+    mSidechainDelaySlider.removeListener(this);
+    mEcoModeButton.removeListener(this);
+    mCubicButton.removeListener(this);
+    mClearBufButton.removeListener(this);
+    mOscPortEditor.removeListener(this);
+    mOscBindEditor.removeListener(this);
 }
 
 //==============================================================================
 void FlangerAudioProcessorEditor::sliderValueChanged(juce::Slider *slider)
 
 {
+    // everything here is read on the audio thread, so it all goes through the command
+    // queue and the audio thread stays the only writer
     if (slider == &mLfoDepthSlider)
     {
         double depth = mLfoDepthSlider.getValue()/100.0f;
         
-        audioProcessor.setDepthTarget(depth);
+        audioProcessor.pushCommand({ FlangerCommand::depth, (float) depth });
         
         DBG("LFO Depth: " + juce::String(depth));
     }
     else if (slider == &mFeedbackSlider)
-        audioProcessor.mFeedbackGain = mFeedbackSlider.getValue()/100.0f;
+        audioProcessor.pushCommand({ FlangerCommand::feedback, (float) mFeedbackSlider.getValue() / 100.0f });
     else if (slider == &mLfoFrequencySlider)
-    {
-        audioProcessor.mLfoFreqSliderValue = mLfoFrequencySlider.getValue();
-        audioProcessor.setLfoFreq(audioProcessor.mLfoFreqSliderValue);
-    }
+        audioProcessor.pushCommand({ FlangerCommand::frequency, (float) mLfoFrequencySlider.getValue() });
+    else if (slider == &mLfoMorphSlider)
+        audioProcessor.pushCommand({ FlangerCommand::morph, (float) mLfoMorphSlider.getValue() });
+    else if (slider == &mSidechainDepthSlider)
+        audioProcessor.pushCommand({ FlangerCommand::sidechainDepth, (float) mSidechainDepthSlider.getValue() / 100.0f });
+    else if (slider == &mSidechainDelaySlider)
+        audioProcessor.pushCommand({ FlangerCommand::sidechainDelay, (float) mSidechainDelaySlider.getValue() / 100.0f });
     
 }
 
 void FlangerAudioProcessorEditor::comboBoxChanged(juce::ComboBox *comboBox)
 {
-       switch (mLfoContraryMotionTypeBox.getSelectedId())
-       {
-           case contrary:
-               audioProcessor.mContraryMotionFlag = true;
-               break;
-           case sync:
-               audioProcessor.mContraryMotionFlag = false;
-               break;
-           default:
-               break;
-       }
-    
-        switch (mLfoTypeBox.getSelectedId())
-        {
-            case sine:
-                audioProcessor.mLfoFlag = true;
-                break;
-            case saw:
-                audioProcessor.mLfoFlag = false;
-        }
+    if (comboBox == &mLfoContraryMotionTypeBox)
+    {
+        auto motion = mLfoContraryMotionTypeBox.getSelectedId();
+        
+        if (motion == contrary || motion == sync)
+            audioProcessor.pushCommand({ FlangerCommand::motion, (float) motion });
+    }
+    else if (comboBox == &mLfoTypeBox)
+    {
+        auto type = mLfoTypeBox.getSelectedId();
+        
+        audioProcessor.pushCommand({ FlangerCommand::lfoType, (float) type });
+        mLfoMorphSlider.setValue(type - sine, juce::dontSendNotification);
+    }
+}
+void FlangerAudioProcessorEditor::buttonClicked(juce::Button *button)
+{
+    if (button == &mEcoModeButton)
+        audioProcessor.setEcoMode(mEcoModeButton.getToggleState());
+    else if (button == &mCubicButton)
+        audioProcessor.setCubicInterpolation(mCubicButton.getToggleState());
+    else if (button == &mClearBufButton)
+        audioProcessor.requestClear();
+}
+void FlangerAudioProcessorEditor::labelTextChanged(juce::Label *label)
+{
+    if (label == &mOscPortEditor)
+    {
+        auto port = mOscPortEditor.getText().getIntValue();
+        
+        if (port > 0 && audioProcessor.startOscControl(port, mOscBindEditor.getText().trim()))
+            return;
+        
+        audioProcessor.stopOscControl();
+        mOscPortEditor.setText("Off", juce::dontSendNotification);
+    }
+    else if (label == &mOscBindEditor)
+    {
+        auto port = audioProcessor.getOscPort();
+        auto previous = audioProcessor.getOscBindAddress();
+        
+        // with OSC off the address is just remembered for the next port the user enters
+        if (port <= 0 || audioProcessor.startOscControl(port, mOscBindEditor.getText().trim()))
+            return;
+        
+        // the new address wouldn't bind, so go back to the one that did
+        audioProcessor.startOscControl(port, previous);
+        mOscBindEditor.setText(previous, juce::dontSendNotification);
+    }
+}
+void FlangerAudioProcessorEditor::timerCallback()
+{
+    auto tier = audioProcessor.getGovernorTier();
+    auto text = "CPU " + FlangerAudioProcessor::getGovernorTierName(tier)
+              + " " + juce::String(juce::roundToInt(100.0f * audioProcessor.getGovernorLoad())) + "%";
+    
+    if (text != mGovernorLabel.getText())
+        mGovernorLabel.setText(text, juce::dontSendNotification);
 }
 //==============================================================================
 void FlangerAudioProcessorEditor::paint (juce::Graphics& g)
@@ -153,8 +295,30 @@ void FlangerAudioProcessorEditor::resized()
     
     mFeedbackSlider.setBounds(300, 150, 300, 50);
     
+    mLfoMorphSlider.setBounds(150, 225, 300, 50);
+    
+    mSidechainDepthSlider.setBounds(530, 225, 60, 60);
+    
+    mSidechainDelaySlider.setBounds(610, 225, 60, 60);
+    
     mLfoTypeBox.setBounds(150, 300, 75, 50);
     
     mLfoContraryMotionTypeBox.setBounds(350, 300, 75, 50);
+    
+    mCubicButton.setBounds(430, 300, 70, 50);
+    
+    mEcoModeButton.setBounds(500, 300, 75, 50);
+    
+    mClearBufButton.setBounds(600, 310, 70, 30);
+    
+    mOscPortEditor.setBounds(600, 30, 70, 25);
+    
+    mOscBindEditor.setBounds(560, 60, 110, 25);
+    
+    mGovernorLabel.setBounds(410, 30, 110, 25);
+    
+    mScope.setBounds(20, 365, 660, 120);
+    
+    mShapeEditor.setBounds(20, 495, 660, 90);
 }
 
@@ -10,11 +10,13 @@
 
 #include <JuceHeader.h>
 #include "PluginProcessor.h"
+#include "FlangerScope.h"
+#include "FlangerShapeEditor.h"
 
 //==============================================================================
 /**
 */
-class FlangerAudioProcessorEditor  :public juce::AudioProcessorEditor, juce::Slider::Listener, juce::ComboBox::Listener
+class FlangerAudioProcessorEditor  :public juce::AudioProcessorEditor, juce::Slider::Listener, juce::ComboBox::Listener, juce::Button::Listener, juce::Label::Listener, juce::Timer
 {
 public:
     FlangerAudioProcessorEditor (FlangerAudioProcessor&);
@@ -44,11 +46,40 @@ private:
     juce::Slider mLfoDepthSlider;
     juce::Label mLfoDepthLabel;
     
+    juce::Slider mLfoMorphSlider;
+    juce::Label mLfoMorphLabel;
+    
+    juce::Slider mSidechainDepthSlider;
+    juce::Label mSidechainDepthLabel;
+    
+    juce::Slider mSidechainDelaySlider;
+    juce::Label mSidechainDelayLabel;
+    
     juce::TextButton mClearBufButton;
     
+    juce::ToggleButton mEcoModeButton;
+    
+    juce::ToggleButton mCubicButton;
+    
+    juce::Label mOscPortEditor;
+    juce::Label mOscPortLabel;
+    
+    // the interface OSC listens on, 127.0.0.1 unless the user opens it up
+    juce::Label mOscBindEditor;
+    juce::Label mOscBindLabel;
+    
+    // the CPU governor's tier and load, polled a few times a second
+    juce::Label mGovernorLabel;
+    
+    FlangerScope mScope;
+    
+    FlangerShapeEditor mShapeEditor;
+    
     void sliderValueChanged(juce::Slider* slider) override;
     void comboBoxChanged(juce::ComboBox* comboBox) override;
-    //void buttonClicked(juce::Button* button) override;
+    void buttonClicked(juce::Button* button) override;
+    void labelTextChanged(juce::Label* label) override;
+    void timerCallback() override;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (FlangerAudioProcessorEditor)
 };
@@ -16,6 +16,7 @@ FlangerAudioProcessor::FlangerAudioProcessor()
                      #if ! JucePlugin_IsMidiEffect
                       #if ! JucePlugin_IsSynth
                        .withInput  ("Input",  juce::AudioChannelSet::stereo(), true)
+                       .withInput  ("Sidechain", juce::AudioChannelSet::stereo(), false)
                       #endif
                        .withOutput ("Output", juce::AudioChannelSet::stereo(), true)
                      #endif
@@ -24,22 +25,52 @@ FlangerAudioProcessor::FlangerAudioProcessor()
 {
     mSampleRate = 48000;
     mBlockSize = 1024;
-   // mDelayTimeSamps = DELAYTIMESAMPSINIT;
-   // mFeedbackGain = FEEDBACKGAININIT;
-   // mLfoFreqSliderValue = LFOFREQINIT;
-    
-    
+    // the editor only mirrors these, so a processor without one (the headless host) needs them set
+    mFeedbackGain = FEEDBACKGAININIT;
+    mLfoFreqSliderValue = LFOFREQINIT;
+    mContraryMotionFlag = true;
+    mLfoFreqHz = mLfoFreqSliderValue;
+    mEcoModeActive = false;
+    mEcoRemaining = 0;
+    mEcoStride = ECOSTRIDE;
+    mCubicActive = false;
+    mScopeCountdown = SCOPEDECIMATION;
+    mScopeInputPeak = 0.0f;
+    mScopeOutputPeak = 0.0f;
+    mLfoType = saw;
+    setLfoType(mLfoType);
     
-    mRingBuf.debug(true);
+    mClearState = clearIdle;
+    mTapGain = 1.0f;
+    mClearFrames = 0;
+    mDelayLineFrames = 0;
+    mGovernorTier = tierFull;
+    mGovernorTierLogged = tierFull;
+    mGovernorLoad = 0.0;
+    mGovernorHeadroomSamples = 0;
+    mGovernorSettleSamples = 0;
+    resetSidechain();
+    mSidechainAttackCoeff = 0.0f;
+    mSidechainReleaseCoeff = 0.0f;
+    mSidechainDepthAmount = 0.0f;
+    mSidechainDelayAmount = 0.0f;
+    mKillTailWasOn = false;
+    mWasPlaying = false;
+    addParameter(mKillTailParam = new juce::AudioParameterBool("killTail", "Kill Tail", false));
+   // mDelayTimeSamps = DELAYTIMESAMPSINIT;
 }
 
 FlangerAudioProcessor::~FlangerAudioProcessor()
 {
+    mDeferredAllocator->removeClient(this);
+    mGovernorMonitor->removeClient(this);
 }
 
 //==============================================================================
 void FlangerAudioProcessor::setLfoFreq(double freq)
 {
+    mLfoFreqHz = freq;
+    
     for (int channel = 0; channel < mNumInputChannels; channel++)
     {
         if (mContraryMotionFlag)
@@ -60,20 +91,52 @@ void FlangerAudioProcessor::setLfoFreq(double freq)
 
 void FlangerAudioProcessor::setLfoType(int type)
 {
-    for (int channel = 0; channel < mNumInputChannels; channel++)
+    if (type < sine || type > userShape)
+        return;
+    
+    mLfoType = type;
+    // straight to the new shape rather than gliding through the ones in between
+    for (int channel = 0; channel < 2; channel++)
+        mLfoArray[channel].setShape(type - sine);
+}
+
+void FlangerAudioProcessor::setLfoMorph(float morph)
+{
+    for (int channel = 0; channel < 2; channel++)
+        mLfoArray[channel].setMorph(morph);
+}
+
+float FlangerAudioProcessor::getLfoMorph() const
+{
+    return mLfoArray[0].getMorph();
+}
+
+bool FlangerAudioProcessor::setUserLfoShape(const float* values, int numValues)
+{
+    if (numValues < 2 || mUserLfoPublished != mUserLfoActive)
+        return false;
+    
+    auto spare = mUserLfoPublished == 0 ? 1 : 0;
+    auto& table = mUserLfoTables[spare];
+    table.resize(WAVETABLESIZE + 1);
+    
+    for (int i = 0; i <= WAVETABLESIZE; i++)
     {
-        switch (mLfoTypeComboBoxValue)
-        {
-            case 1:
-                mLfoArray[channel].setType(atec::LFO::sin);
-                break;
-            case 2:
-                mLfoArray[channel].setType(atec::LFO::saw);
-                break;
-            default:
-                break;
-        }
+        // the drawn shape is one cycle, so the last point wraps round to the first
+        auto position = (float) (i % WAVETABLESIZE) * (float) numValues / (float) WAVETABLESIZE;
+        auto index = (int) position;
+        auto next = (index + 1) % numValues;
+        table[i] = juce::jlimit(0.0f, 1.0f, values[index] + (position - (float) index) * (values[next] - values[index]));
     }
+    
+    mUserLfoPoints.assign(values, values + numValues);
+    mUserLfoPublished = spare;
+    return true;
+}
+
+const std::vector<float>& FlangerAudioProcessor::getUserLfoPoints() const
+{
+    return mUserLfoPoints;
 }
 
 void FlangerAudioProcessor::setDepthTarget(double depth)
@@ -87,6 +150,355 @@ double FlangerAudioProcessor::getDepthTarget()
     return mLfoDepth[0].getTargetValue();
 }
 
+void FlangerAudioProcessor::setEcoMode(bool shouldUseEcoMode)
+{
+    mEcoModeRequested = shouldUseEcoMode;
+}
+
+bool FlangerAudioProcessor::getEcoMode() const
+{
+    return mEcoModeRequested;
+}
+
+void FlangerAudioProcessor::setCpuBudget(float fraction)
+{
+    mCpuBudget = juce::jlimit(0.0f, 1.0f, fraction);
+}
+
+float FlangerAudioProcessor::getCpuBudget() const
+{
+    return mCpuBudget;
+}
+
+int FlangerAudioProcessor::getGovernorTier() const
+{
+    return mGovernorTierPublished;
+}
+
+float FlangerAudioProcessor::getGovernorLoad() const
+{
+    return mGovernorLoadPublished;
+}
+
+juce::String FlangerAudioProcessor::getGovernorTierName(int tier)
+{
+    switch (tier)
+    {
+        case tierFull:      return "full";
+        case tierLinear:    return "linear";
+        case tierEco:       return "eco";
+        case tierCoarse:    return "coarse";
+        default:            return {};
+    }
+}
+
+void FlangerAudioProcessor::setInjectedLoad(float factor)
+{
+    mInjectedLoad = juce::jmax(0.0f, factor);
+}
+
+void FlangerAudioProcessor::updateGovernor(juce::int64 startTicks, int numSamples)
+{
+    auto elapsedTicks = juce::Time::getHighResolutionTicks() - startTicks;
+    
+    auto injectedLoad = mInjectedLoad.load();
+    if (injectedLoad > 0.0f)
+    {
+        auto endTicks = startTicks + elapsedTicks + (juce::int64) (elapsedTicks * injectedLoad);
+        while (juce::Time::getHighResolutionTicks() < endTicks) {}
+        elapsedTicks = juce::Time::getHighResolutionTicks() - startTicks;
+    }
+    
+    // share of the period this block took, averaged over GOVERNORSMOOTHING seconds of
+    // audio so one preempted callback doesn't cost a tier
+    auto load = juce::Time::highResolutionTicksToSeconds(elapsedTicks) * mSampleRate / numSamples;
+    mGovernorLoad += (load - mGovernorLoad) * juce::jmin(1.0, numSamples / (GOVERNORSMOOTHING * mSampleRate));
+    mGovernorLoadPublished = (float) mGovernorLoad;
+    
+    auto budget = mCpuBudget.load();
+    auto tier = mGovernorTier;
+    mGovernorSettleSamples = juce::jmax(0, mGovernorSettleSamples - numSamples);
+    
+    if (budget <= 0.0f || isNonRealtime())
+    {
+        tier = tierFull;
+        mGovernorHeadroomSamples = 0;
+    }
+    else if (mGovernorLoad > budget)
+    {
+        // one step at a time, and only once the last step shows in the average
+        mGovernorHeadroomSamples = 0;
+        
+        if (tier < tierCoarse && mGovernorSettleSamples == 0)
+        {
+            tier++;
+            
+            // with linear taps already in use the linear tier would save nothing
+            if (tier == tierLinear && ! mCubicRequested)
+                tier++;
+        }
+    }
+    else if (mGovernorLoad < budget * GOVERNORHYSTERESIS)
+    {
+        // back up only after a sustained stretch well under budget, so a tier whose
+        // savings are what keep it under budget doesn't flap
+        mGovernorHeadroomSamples += numSamples;
+        
+        if (tier > tierFull && mGovernorHeadroomSamples >= GOVERNORHOLDTIME * mSampleRate)
+        {
+            tier--;
+            mGovernorHeadroomSamples = 0;
+            
+            if (tier == tierLinear && ! mCubicRequested)
+                tier--;
+        }
+    }
+    else
+    {
+        mGovernorHeadroomSamples = 0;
+    }
+    
+    if (tier != mGovernorTier)
+    {
+        mGovernorTier = tier;
+        mGovernorSettleSamples = (int) (GOVERNORSETTLETIME * mSampleRate);
+        mGovernorTierPublished = tier;
+    }
+}
+
+void FlangerAudioProcessor::setScopeEnabled(bool shouldPublish)
+{
+    mScopeEnabled = shouldPublish;
+}
+
+bool FlangerAudioProcessor::popScopeSnapshot(ScopeSnapshot& snapshot)
+{
+    return mScopeFifo.pop(snapshot);
+}
+
+bool FlangerAudioProcessor::startOscControl(int port, const juce::String& bindAddress)
+{
+    return mOscReceiver.connect(port, bindAddress);
+}
+
+void FlangerAudioProcessor::stopOscControl()
+{
+    mOscReceiver.disconnect();
+}
+
+int FlangerAudioProcessor::getOscPort() const
+{
+    return mOscReceiver.getPort();
+}
+
+juce::String FlangerAudioProcessor::getOscBindAddress() const
+{
+    return mOscReceiver.getBindAddress();
+}
+
+bool FlangerAudioProcessor::pushCommand(const FlangerCommand& command)
+{
+    const juce::SpinLock::ScopedLockType lock(mCommandWriteLock);
+    
+    if (mCommandFifo.push(command))
+        return true;
+    
+    mCommandsDropped++;
+    return false;
+}
+
+int FlangerAudioProcessor::getNumCommandsApplied() const
+{
+    return mCommandsApplied;
+}
+
+int FlangerAudioProcessor::getNumCommandsDropped() const
+{
+    return mCommandsDropped;
+}
+
+bool FlangerAudioProcessor::isDelayLineAllocated() const
+{
+    return mDelayLineReady;
+}
+
+void FlangerAudioProcessor::requestClear()
+{
+    mClearRequested = true;
+}
+
+void FlangerAudioProcessor::advanceClear(int numSamples)
+{
+    auto fadeStep = (float) numSamples / CLEARFADESAMPLES;
+    
+    switch (mClearState)
+    {
+        case clearFadingOut:
+            if (mTapGain > 0.0f)
+            {
+                mTapGain = juce::jmax(0.0f, mTapGain - fadeStep);
+                break;
+            }
+            
+            // the taps are silent from here on, so the zeroing can't be heard
+            mDelayLine.beginClear(mClearFrames);
+            mClearState = clearZeroing;
+            JUCE_FALLTHROUGH
+        case clearZeroing:
+            // never fewer frames than the tile writes, so the zeroing stays ahead of the write head
+            if (mDelayLine.continueClear(CLEARFRAMESPERSAMPLE * numSamples))
+                mClearState = clearFadingIn;
+            break;
+        case clearFadingIn:
+            mTapGain = juce::jmin(1.0f, mTapGain + fadeStep);
+            if (mTapGain >= 1.0f)
+                mClearState = clearIdle;
+            break;
+        default:
+            break;
+    }
+}
+
+float FlangerAudioProcessor::getSidechainDepthAmount() const
+{
+    return mSidechainDepthAmount;
+}
+
+float FlangerAudioProcessor::getSidechainDelayAmount() const
+{
+    return mSidechainDelayAmount;
+}
+
+void FlangerAudioProcessor::followSidechain(const juce::AudioBuffer<float>& sidechain, int start, int numLanes, int numSamples)
+{
+    // Vectorised peak scans and one attack/release step per SIDECHAINSTRIDE samples.
+    // Each step's envelope is ramped across the following step, so the modulation
+    // doesn't step and trails the sidechain by one stride (0.7 ms at 48 kHz) while
+    // the audio gets no latency at all. Everything is counted in stream time, so
+    // the result doesn't depend on how the host splits the buffer.
+    auto modulate = mSidechainDepthAmount != 0.0f || mSidechainDelayAmount != 0.0f;
+    auto maxDelay = (float) mMaxDelaySamps;
+    
+    for (int done = 0; done < numSamples;)
+    {
+        auto n = juce::jmin(mSidechainRemaining, numSamples - done);
+        
+        for (int channel = 0; channel < sidechain.getNumChannels(); ++channel)
+            mSidechainPeak = juce::jmax(mSidechainPeak, sidechain.getMagnitude(channel, start + done, n));
+        
+        if (modulate)
+        {
+            // d' = d * (1 - depth * env) * (1 - delay * env) + delay * env * max, never past max
+            auto position = SIDECHAINSTRIDE - mSidechainRemaining;
+            auto envelopeStep = (mSidechainEnvelope - mSidechainRampStart) / SIDECHAINSTRIDE;
+            
+            for (int channel = 0; channel < numLanes; ++channel)
+            {
+                auto* delayTimePtr = mDelayTimeBlock.getWritePointer(channel) + done;
+                
+                for (int i = 0; i < n; i++)
+                {
+                    auto envelope = mSidechainRampStart + envelopeStep * (float) (position + i + 1);
+                    auto push = mSidechainDelayAmount * envelope;
+                    
+                    delayTimePtr[i] = delayTimePtr[i] * (1.0f - mSidechainDepthAmount * envelope) * (1.0f - push) + push * maxDelay;
+                }
+            }
+        }
+        
+        done += n;
+        mSidechainRemaining -= n;
+        
+        if (mSidechainRemaining == 0)
+        {
+            // overs would push the delay past the reach of the ring
+            auto level = juce::jmin(mSidechainPeak, 1.0f);
+            auto coeff = level > mSidechainEnvelope ? mSidechainAttackCoeff : mSidechainReleaseCoeff;
+            
+            mSidechainRampStart = mSidechainEnvelope;
+            mSidechainEnvelope = level + coeff * (mSidechainEnvelope - level);
+            mSidechainPeak = 0.0f;
+            mSidechainRemaining = SIDECHAINSTRIDE;
+        }
+    }
+}
+
+void FlangerAudioProcessor::resetSidechain()
+{
+    mSidechainEnvelope = 0.0f;
+    mSidechainRampStart = 0.0f;
+    mSidechainPeak = 0.0f;
+    mSidechainRemaining = SIDECHAINSTRIDE;
+}
+
+void FlangerAudioProcessor::applyCommand(const FlangerCommand& command)
+{
+    switch (command.type)
+    {
+        case FlangerCommand::frequency:
+            mLfoFreqSliderValue = juce::jlimit(0.0f, 3.0f, command.value);
+            setLfoFreq(mLfoFreqSliderValue);
+            break;
+        case FlangerCommand::depth:
+            setDepthTarget(juce::jlimit(0.0f, 1.0f, command.value));
+            break;
+        case FlangerCommand::feedback:
+            mFeedbackGain = juce::jlimit(0.0f, 0.99f, command.value);
+            break;
+        case FlangerCommand::lfoType:
+            setLfoType((int) command.value);
+            break;
+        case FlangerCommand::motion:
+            mContraryMotionFlag = (int) command.value == contrary;
+            setLfoFreq(mLfoFreqHz);
+            break;
+        case FlangerCommand::morph:
+            setLfoMorph(command.value);
+            break;
+        case FlangerCommand::clear:
+            mClearRequested = true;
+            break;
+        case FlangerCommand::sidechainDepth:
+            mSidechainDepthAmount = juce::jlimit(0.0f, 1.0f, command.value);
+            break;
+        case FlangerCommand::sidechainDelay:
+            mSidechainDelayAmount = juce::jlimit(0.0f, 1.0f, command.value);
+            break;
+        case FlangerCommand::cpuBudget:
+            setCpuBudget(command.value);
+            break;
+        default:
+            break;
+    }
+}
+
+void FlangerAudioProcessor::setCubicInterpolation(bool shouldUseCubic)
+{
+    mCubicRequested = shouldUseCubic;
+}
+
+bool FlangerAudioProcessor::getCubicInterpolation() const
+{
+    return mCubicRequested;
+}
+
+void FlangerAudioProcessor::updateLfoRate()
+{
+    // in eco mode each getNextSample() call stands for mEcoStride audio samples,
+    // so the LFOs run at the control rate. The phase is left where it is.
+    auto lfoSampleRate = mEcoModeActive ? mSampleRate / mEcoStride : mSampleRate;
+    
+    for (int channel = 0; channel < 2; channel++)
+    {
+        mLfoArray[channel].setSampleRate(lfoSampleRate);
+        
+        if (mContraryMotionFlag && channel == 1)
+            mLfoArray[channel].setFreq(mLfoFreqHz * -1);
+        else
+            mLfoArray[channel].setFreq(mLfoFreqHz);
+    }
+}
+
 
 const juce::String FlangerAudioProcessor::getName() const
 {
@@ -154,22 +566,62 @@ void FlangerAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBloc
 {
     // Use this method as the place to do any pre-playback
     // initialisation that you need..
-    mNumInputChannels = getTotalNumInputChannels();
+    // the sidechain's channels come after these and are never processed as lanes
+    mNumInputChannels = getMainBusNumInputChannels();
     
     mSampleRate = sampleRate;
     mBlockSize = samplesPerBlock;
     
     mMaxDelaySamps = MAXDELAYTIME * mSampleRate;
     
-    // make the ring buffer size a multiple of the host block size for wraparound convenience
-    mRingBuffSize = sampleRate * 1.25;
-    // in units of blocks
-    mRingBuffSize = floor(mRingBuffSize/(float)mBlockSize);
-    mRingBuffSize *= mBlockSize;
+    // the longest tap plus the cubic read's extra points is all a tail clear needs to zero
+    mClearFrames = (int) std::ceil(mMaxDelaySamps) + DELAYGUARDFRAMES + 1;
+    
+    // The ring only has to reach the longest tap, sized by time so it never depends
+    // on the host block size. A ring that already fits is kept and cleared; anything
+    // else is dropped and allocated again once audio actually arrives.
+    {
+        const juce::ScopedLock sl(mDelayLineLock);
+        mDelayLineFrames = mClearFrames + 1;
+        
+        if (mDelayLineReady && mDelayLine.getSize() == juce::nextPowerOfTwo(mDelayLineFrames))
+        {
+            mDelayLine.clear();
+        }
+        else
+        {
+            mDelayLineReady = false;
+            mDelayLine.release();
+        }
+        
+        mDelayLineRequested = false;
+    }
+    
+    if (! mDelayLineReady)
+        mDeferredAllocator->addClient(this);
+    
+    mClearState = clearIdle;
+    mTapGain = 1.0f;
+    
+    // built once per process and shared, so only the first instance pays for it
+    mInterpolationTable = mSharedTables->getInterpolationTable(INTERPTABLESTEPS);
+    mGovernorTier = tierFull;
+    mGovernorLoad = 0.0;
+    mGovernorHeadroomSamples = 0;
+    mGovernorSettleSamples = 0;
+    
+    // a fresh start isn't a tier change, so the monitor won't log it
+    mGovernorMonitor->removeClient(this);
+    mGovernorTierPublished = tierFull;
+    mGovernorTierLogged = tierFull;
+    mGovernorMonitor->addClient(this);
     
-    // 3-second ring buffer
-    mRingBuf.setSize(mNumInputChannels, 3.0f * mSampleRate, mBlockSize);
-    mRingBuf.init();
+    mCubicActive = mCubicRequested;
+    mDelayLine.setInterpolationTable(mCubicActive ? mInterpolationTable : nullptr);
+    mWaveTables = mSharedTables->getWaveTables(WAVETABLESIZE);
+    DBG(mSharedTables->getReport());
+    
+    mDelayTimeBlock.setSize(2, SUBBLOCKSIZE);
     
     mDelayTimeSamps[0].setTargetValue(DELAYTIMESAMPSINIT);
     mDelayTimeSamps[1].setTargetValue(DELAYTIMESAMPSINIT);
@@ -177,23 +629,91 @@ void FlangerAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBloc
     mDelayTimeSamps[0].reset(mSampleRate, 3.0f);
     mDelayTimeSamps[1].reset(mSampleRate, 3.0f);
     
-    mRingBuffWriteIdx = 0;
+    for (int channel = 0; channel < 2; channel++)
+        mLfoArray[channel].setTables(mWaveTables);
     
     for (int channel = 0; channel < mNumInputChannels; channel++)
     {
-        mLfoArray[channel].setType(atec::LFO::saw);
-        mLfoArray[channel].setSampleRate(mSampleRate);
-        mLfoArray[channel].setFreq(7.0f);
-        
         mLfoDepth[channel].setTargetValue(LFODEPTHINIT);
         mLfoDepth[channel].reset(mSampleRate, 3.0f);
+        
+        mEcoStart[channel] = 0.0f;
+        mEcoValue[channel] = 0.0f;
+        mEcoStep[channel] = 0.0f;
     }
+    
+    // start at the rate the processor reports, not one the editor then has to correct
+    mLfoFreqHz = mLfoFreqSliderValue;
+    mEcoModeActive = mEcoModeRequested;
+    mEcoStride = ECOSTRIDE;
+    mEcoRemaining = 0;
+    updateLfoRate();
+    
+    mScopeCountdown = SCOPEDECIMATION;
+    mScopeInputPeak = 0.0f;
+    mScopeOutputPeak = 0.0f;
+    
+    resetSidechain();
+    mSidechainAttackCoeff = (float) std::exp(-SIDECHAINSTRIDE / (SIDECHAINATTACK * mSampleRate));
+    mSidechainReleaseCoeff = (float) std::exp(-SIDECHAINSTRIDE / (SIDECHAINRELEASE * mSampleRate));
 }
 
 void FlangerAudioProcessor::releaseResources()
 {
-    // When playback stops, you can use this as an opportunity to free up any
-    // spare memory, etc.
+    // an idle instance keeps nothing but its parameters; prepareToPlay fetches it all again
+    mDeferredAllocator->removeClient(this);
+    mGovernorMonitor->removeClient(this);
+    
+    {
+        const juce::ScopedLock sl(mDelayLineLock);
+        mDelayLineReady = false;
+        mDelayLineRequested = false;
+        mDelayLineFrames = 0;
+        mDelayLine.release();
+    }
+    
+    mDelayLine.setInterpolationTable(nullptr);
+    mDelayTimeBlock.setSize(0, 0);
+    
+    for (int channel = 0; channel < 2; channel++)
+        mLfoArray[channel].setTables(nullptr);
+    
+    // the last instance to let go frees the shared tables
+    mInterpolationTable.reset();
+    mWaveTables.reset();
+}
+
+void FlangerAudioProcessor::allocateDelayLine()
+{
+    const juce::ScopedLock sl(mDelayLineLock);
+    
+    // released or re-prepared since the request went out
+    if (mDelayLineReady || mDelayLineFrames == 0)
+        return;
+    
+    mDelayLine.setSize(mDelayLineFrames);
+    mDelayLineReady = true;
+}
+
+bool FlangerAudioProcessor::performDeferredAllocation()
+{
+    if (mDelayLineRequested)
+        allocateDelayLine();
+    
+    return mDelayLineReady;
+}
+
+void FlangerAudioProcessor::logGovernorTier()
+{
+    auto tier = mGovernorTierPublished.load();
+    
+    if (tier == mGovernorTierLogged)
+        return;
+    
+    juce::Logger::writeToLog("Flanger: CPU governor " + juce::String(tier > mGovernorTierLogged ? "down" : "up")
+                             + " to " + getGovernorTierName(tier) + " at "
+                             + juce::String(100.0f * mGovernorLoadPublished.load(), 0) + "% load");
+    mGovernorTierLogged = tier;
 }
 
 #ifndef JucePlugin_PreferredChannelConfigurations
@@ -215,6 +735,17 @@ bool FlangerAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts)
    #if ! JucePlugin_IsSynth
     if (layouts.getMainOutputChannelSet() != layouts.getMainInputChannelSet())
         return false;
+    
+    // the sidechain is optional, and mono or stereo when it is there
+    if (layouts.inputBuses.size() > 1)
+    {
+        auto sidechainSet = layouts.getChannelSet(true, 1);
+        
+        if (! sidechainSet.isDisabled()
+         && sidechainSet != juce::AudioChannelSet::mono()
+         && sidechainSet != juce::AudioChannelSet::stereo())
+            return false;
+    }
    #endif
 
     return true;
@@ -225,10 +756,11 @@ bool FlangerAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts)
 void FlangerAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
 {
     juce::ScopedNoDenormals noDenormals;
-    auto totalNumInputChannels  = getTotalNumInputChannels();
+    auto startTicks = juce::Time::getHighResolutionTicks();
+    // main bus only; the sidechain's channels follow the main input's in the buffer
+    auto totalNumInputChannels  = getMainBusNumInputChannels();
     auto totalNumOutputChannels = getTotalNumOutputChannels();
     auto buffSize = buffer.getNumSamples();
-    juce::AudioBuffer<float> delayBlock;
 
     // In case we have more outputs than inputs, this code clears any output
     // channels that didn't contain input data, (because these aren't
@@ -239,47 +771,263 @@ void FlangerAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce
     for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
         buffer.clear (i, 0, buffer.getNumSamples());
 
-    // buffer to store per-block processing, should be the same size as incoming buffer from host.
-    delayBlock.setSize(totalNumInputChannels, buffSize);
-    // clear the delay block buffer for good measure (all channels)
-    delayBlock.clear();
-    
-    // This is the place where you'd normally do the guts of your plugin's
-    // audio processing...
-    // Make sure to reset the state if your inner loop is processing
-    // the samples and the outer loop is handling the channels.
-    // Alternatively, you can process the samples with the channels
-    // interleaved by keeping the same state.
-    for (int channel = 0; channel < totalNumInputChannels; ++channel)
+    // remote commands land here, on the audio thread, before anything reads the parameters
+    FlangerCommand command;
+    int numApplied = 0;
+    
+    while (mCommandFifo.pop(command))
     {
-        //auto* channelData = buffer.getWritePointer (channel);
-        auto* delayBlockPtr = delayBlock.getWritePointer(channel);
-        //auto* ringBuffPtr = mRingBuf.getReadPointer(channel);
-      
-        for (int i = 0; i < buffSize; i++)
+        applyCommand(command);
+        numApplied++;
+    }
+    
+    // one atomic add per block, and none on a block without commands
+    if (numApplied > 0)
+        mCommandsApplied += numApplied;
+    
+    // automation and transport stop both kill the tail, on the rising edge / the stop
+    auto killTail = mKillTailParam->get();
+    if (killTail && ! mKillTailWasOn)
+        mClearRequested = true;
+    mKillTailWasOn = killTail;
+    
+    if (auto* playHead = getPlayHead())
+    {
+        juce::AudioPlayHead::CurrentPositionInfo positionInfo;
+        
+        if (playHead->getCurrentPosition(positionInfo))
+        {
+            if (mWasPlaying && ! positionInfo.isPlaying)
+                mClearRequested = true;
+            mWasPlaying = positionInfo.isPlaying;
+        }
+    }
+    
+    // a request during a clear starts it over, fading out from wherever the gain is
+    if (mClearRequested.exchange(false))
+        mClearState = clearFadingOut;
+    
+    // the delay line and LFOs hold two lanes; mono runs the same kernel on lane 0
+    auto numLanes = juce::jmin(totalNumInputChannels, 2);
+    if (numLanes == 0)
+        return;
+    
+    // the governor can force eco mode and linear taps on top of what was asked for;
+    // the eco ramp restarts from where the curve is, so a switch doesn't jump
+    auto ecoMode = mEcoModeRequested || mGovernorTier >= tierEco;
+    auto ecoStride = mGovernorTier >= tierCoarse ? ECOSTRIDECOARSE : ECOSTRIDE;
+    
+    if (ecoMode != mEcoModeActive || (ecoMode && ecoStride != mEcoStride))
+    {
+        mEcoModeActive = ecoMode;
+        mEcoStride = ecoStride;
+        updateLfoRate();
+        mEcoRemaining = 0;
+    }
+    
+    auto userLfo = mUserLfoPublished.load();
+    if (userLfo != mUserLfoActive)
+    {
+        for (int channel = 0; channel < 2; channel++)
+            mLfoArray[channel].setUserTable(mUserLfoTables[userLfo].data());
+        mUserLfoActive = userLfo;
+    }
+    
+    auto cubic = mCubicRequested && mGovernorTier < tierLinear;
+    
+    if (cubic != mCubicActive)
+    {
+        mCubicActive = cubic;
+        mDelayLine.setInterpolationTable(mCubicActive ? mInterpolationTable : nullptr);
+    }
+    
+    // the main bus's channels only, so the sidechain never reaches the scope or the output gain
+    auto mainBuffer = getBusBuffer(buffer, false, 0);
+    
+    // An instance that never sees a signal never allocates its ring. The first
+    // non-silent block raises a flag for the DeferredAllocator's timer and the dry
+    // signal passes meanwhile; an offline render isn't realtime, so it just allocates here.
+    auto delayLineReady = mDelayLineReady.load();
+    
+    if (! delayLineReady && ! mDelayLineRequested)
+    {
+        if (isNonRealtime())
+        {
+            allocateDelayLine();
+            delayLineReady = mDelayLineReady.load();
+        }
+        else if (mainBuffer.getMagnitude(0, buffSize) > 0.0f)
+        {
+            mDelayLineRequested = true;
+            mDeferredAllocator->notifyRequested();
+        }
+    }
+    
+    // nothing in the ring yet, so there is no tail to clear
+    if (! delayLineReady)
+    {
+        mClearState = clearIdle;
+        mTapGain = 1.0f;
+    }
+    
+    auto* leftPtr = buffer.getWritePointer(0);
+    auto* rightPtr = numLanes > 1 ? buffer.getWritePointer(1) : nullptr;
+    // mono reads lane 0's curve for both taps
+    auto rightLane = numLanes > 1 ? 1 : 0;
+    
+    // Walk the host buffer in cache-sized tiles so 1-sample automation blocks and
+    // 32k-sample offline bounces both run on the scratch allocated in prepareToPlay.
+    // Each tile goes through modulation, tap read, mix, ring write and output gain
+    // before the next one starts, so nothing falls out of cache between stages.
+    // The delay line reads and writes frame by frame, and the eco ramp and the
+    // sidechain follower run on stride grids counted in stream time and carried
+    // across calls, so the result is bit-identical however the buffer is split.
+    auto publishScope = mScopeEnabled.load();
+    
+    // a view onto the sidechain channels, empty when the bus is off; nothing is copied
+    auto* sidechainBus = getBus(true, 1);
+    auto sidechain = sidechainBus != nullptr && sidechainBus->isEnabled() ? getBusBuffer(buffer, true, 1)
+                                                                          : juce::AudioBuffer<float>();
+    
+    if (sidechain.getNumChannels() == 0)
+        resetSidechain();
+    
+    for (int start = 0; start < buffSize; start += SUBBLOCKSIZE)
+    {
+        auto numSamples = juce::jmin(SUBBLOCKSIZE, buffSize - start);
+        auto inputPeak = publishScope ? mainBuffer.getMagnitude(start, numSamples) : 0.0f;
+        
+        if (mEcoModeActive)
+            fillDelayTimesEco(numLanes, numSamples);
+        else
+            fillDelayTimes(numLanes, numSamples);
+        
+        if (sidechain.getNumChannels() > 0)
+            followSidechain(sidechain, start, numLanes, numSamples);
+        
+        if (delayLineReady)
         {
-            double thisDelayTime;
+            auto tapGainStart = mTapGain;
+            advanceClear(numSamples);
             
+            mDelayLine.process(mDelayTimeBlock.getReadPointer(0), mDelayTimeBlock.getReadPointer(rightLane),
+                               leftPtr + start, rightPtr != nullptr ? rightPtr + start : nullptr,
+                               numSamples, (float) mFeedbackGain * tapGainStart, (float) mFeedbackGain * mTapGain);
+        }
+        
+        mainBuffer.applyGain(start, numSamples, 0.25);
+        
+        if (publishScope)
+            updateScope(numLanes, numSamples, inputPeak, mainBuffer.getMagnitude(start, numSamples));
+    }
+    
+    if (buffSize > 0)
+        updateGovernor(startTicks, buffSize);
+}
+
+void FlangerAudioProcessor::fillDelayTimes(int numLanes, int numSamples)
+{
+    for (int channel = 0; channel < numLanes; ++channel)
+    {
+        auto* delayTimePtr = mDelayTimeBlock.getWritePointer(channel);
+      
+        for (int i = 0; i < numSamples; i++)
+        {
             if (mLfoFreqSliderValue > 0.0)
-                thisDelayTime = mLfoArray[channel].getNextSample() * mLfoDepth[channel].getNextValue() * mMaxDelaySamps;
+                delayTimePtr[i] = mLfoArray[channel].getNextSample() * mLfoDepth[channel].getNextValue() * mMaxDelaySamps;
             
             else
-                thisDelayTime = mLfoArray[channel].getNextSample() * mMaxDelaySamps;
+                delayTimePtr[i] = mLfoArray[channel].getNextSample() * mMaxDelaySamps;
+        }
+        
+        // so a switch into eco mode ramps on from here instead of from zero
+        if (numSamples > 0)
+            mEcoValue[channel] = delayTimePtr[numSamples - 1];
+    }
+}
+
+void FlangerAudioProcessor::fillDelayTimesEco(int numLanes, int numSamples)
+{
+    // The LFO and depth are only evaluated at control points mEcoStride samples apart,
+    // and the delay-time curve is a linear ramp between them. A control period can
+    // straddle host blocks, so the ramp state carries over between calls.
+    // For a sine of depth D samples at f Hz the interpolation error is bounded by
+    // D * (2 pi f stride / fs)^2 / 8, about 0.024 samples at ECOSTRIDE, 3 Hz, 48 kHz and
+    // full depth, and 16 times that at the governor's ECOSTRIDECOARSE; the curve also
+    // lags the audio-rate one by one stride. A saw's reset is spread over one control
+    // period instead of being a single-sample jump.
+    int i = 0;
+    
+    while (i < numSamples)
+    {
+        if (mEcoRemaining == 0)
+        {
+            for (int channel = 0; channel < numLanes; ++channel)
+            {
+                double target;
+                
+                if (mLfoFreqSliderValue > 0.0)
+                    target = mLfoArray[channel].getNextSample() * mLfoDepth[channel].skip(mEcoStride) * mMaxDelaySamps;
+                else
+                    target = mLfoArray[channel].getNextSample() * mMaxDelaySamps;
+                
+                mEcoStart[channel] = mEcoValue[channel];
+                mEcoStep[channel] = ((float) target - mEcoStart[channel]) / (float) mEcoStride;
+            }
+            
+            mEcoRemaining = mEcoStride;
+        }
+        
+        auto numToRamp = juce::jmin(mEcoRemaining, numSamples - i);
+        // each value comes from the period's start and its position in the period,
+        // never from the last value written, so a split period rounds the same way
+        auto position = mEcoStride - mEcoRemaining;
+        
+        for (int channel = 0; channel < numLanes; ++channel)
+        {
+            auto* delayTimePtr = mDelayTimeBlock.getWritePointer(channel, i);
+            auto start = mEcoStart[channel];
+            auto step = mEcoStep[channel];
+            
+            // branch-free ramp, vectorised by the compiler
+            for (int k = 0; k < numToRamp; k++)
+                delayTimePtr[k] = start + step * (float) (position + k + 1);
             
-            delayBlockPtr[i] = mRingBuf.readInterpSample(channel, i, thisDelayTime);
-            // return delayBlock buffer
-            // want to return samples from the Ring Buffer into the delay block buffer, using the readInterpSample function of Ring Buffer
+            mEcoValue[channel] = delayTimePtr[numToRamp - 1];
         }
+        
+        mEcoRemaining -= numToRamp;
+        i += numToRamp;
+    }
+}
 
-        // reduce amplitude of the delayed block
-        delayBlock.applyGain(channel, 0, buffSize, mFeedbackGain);
-        // ..do something to the data...
-        buffer.addFrom(channel, 0, delayBlock, channel, 0, buffSize);
+void FlangerAudioProcessor::updateScope(int numLanes, int numSamples, float inputPeak, float outputPeak)
+{
+    mScopeInputPeak = juce::jmax(mScopeInputPeak, inputPeak);
+    mScopeOutputPeak = juce::jmax(mScopeOutputPeak, outputPeak);
+    
+    mScopeCountdown -= numSamples;
+    if (mScopeCountdown > 0)
+        return;
+    
+    ScopeSnapshot snapshot;
+    
+    for (int channel = 0; channel < 2; channel++)
+    {
+        auto lane = juce::jmin(channel, numLanes - 1);
+        snapshot.delayTime[channel] = (float) (mDelayTimeBlock.getSample(lane, numSamples - 1) / mMaxDelaySamps);
+        snapshot.lfoPhase[channel] = (float) mLfoArray[channel].getPhase();
     }
     
-    mRingBuf.write(buffer);
+    snapshot.inputLevel = mScopeInputPeak;
+    snapshot.outputLevel = mScopeOutputPeak;
+    
+    // wait-free; if the editor has fallen behind the snapshot is simply dropped
+    mScopeFifo.push(snapshot);
     
-    buffer.applyGain(0, buffSize, 0.25);
+    mScopeCountdown = SCOPEDECIMATION;
+    mScopeInputPeak = 0.0f;
+    mScopeOutputPeak = 0.0f;
 }
 
 //==============================================================================
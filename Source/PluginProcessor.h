@@ -9,11 +9,50 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "StereoDelayLine.h"
+#include "SpscFifo.h"
+#include "FlangerOscReceiver.h"
+#include "SharedTables.h"
+#include "WavetableLfo.h"
+#include "DeferredAllocator.h"
+#include "GovernorMonitor.h"
 
 #define DELAYTIMESAMPSINIT 480
 #define FEEDBACKGAININIT 0.85
 #define LFODEPTHINIT 0.5
+#define LFOFREQINIT 1.0
 #define MAXDELAYTIME .025
+// eco mode evaluates the LFO and depth once per ECOSTRIDE samples and ramps in between
+#define ECOSTRIDE 32
+// the governor's last resort, four times coarser than eco mode
+#define ECOSTRIDECOARSE 128
+// host buffers of any length are processed in tiles of at most this many samples.
+// A tile's delay times and audio for both lanes come to 8 KB, which stays in L1
+// alongside the part of the delay line the taps reach (25 ms, ~9.6 KB at 48 kHz).
+#define SUBBLOCKSIZE 512
+// the scope gets one snapshot per SCOPEDECIMATION samples (~190 per second at 48 kHz)
+#define SCOPEDECIMATION 256
+#define SCOPEFIFOSIZE 128
+// remote commands queued between two blocks; at 48 kHz / 64 samples that is over 3000 msgs/s
+#define COMMANDFIFOSIZE 512
+// a tail clear fades the taps out and back in over this many samples, and in
+// between zeroes this many delay-line frames per sample processed, so the
+// silent stretch is a fixed length of audio whatever the host block size
+#define CLEARFADESAMPLES 1024
+#define CLEARFRAMESPERSAMPLE 4
+// sidechain envelope follower attack and release, in seconds, and the step it runs at:
+// one peak and one envelope update per SIDECHAINSTRIDE samples of stream time
+#define SIDECHAINATTACK 0.005
+#define SIDECHAINRELEASE 0.15
+#define SIDECHAINSTRIDE 32
+// CPU governor: default share of the buffer period processBlock may take, how low the
+// load has to fall (as a share of the budget) and for how long before stepping back up,
+// the time the load is averaged over, and how long to wait after a step before the next
+#define GOVERNORBUDGET 0.7
+#define GOVERNORHYSTERESIS 0.5
+#define GOVERNORHOLDTIME 2.0
+#define GOVERNORSMOOTHING 0.05
+#define GOVERNORSETTLETIME 0.1
 
 enum motionType
 {
@@ -21,15 +60,62 @@ enum motionType
     sync
 };
 
+// combo-box ids; id - 1 is the shape's morph position
 enum lfoType
 {
     sine = 1,
-    saw
+    saw,
+    triangle,
+    square,
+    exponential,
+    smoothRandom,
+    userShape
+};
+
+// processing tiers the CPU governor steps through, most expensive first
+enum governorTier
+{
+    tierFull,       // cubic taps, audio-rate modulation
+    tierLinear,     // linear taps, skipped unless cubic is switched on
+    tierEco,        // linear taps, modulation every ECOSTRIDE samples
+    tierCoarse      // linear taps, modulation every ECOSTRIDECOARSE samples
+};
+
+// one decimated view of the modulation state, published by the audio thread for the editor's scope
+struct ScopeSnapshot
+{
+    float delayTime[2];     // fraction of the maximum delay
+    float lfoPhase[2];      // 0 to 1
+    float inputLevel;       // peak since the last snapshot
+    float outputLevel;
+};
+
+// a parameter change from outside the editor (OSC, headless host), applied at the start of a block
+struct FlangerCommand
+{
+    enum Type
+    {
+        frequency,
+        depth,
+        feedback,
+        lfoType,
+        motion,
+        morph,
+        clear,
+        sidechainDepth,
+        sidechainDelay,
+        cpuBudget
+    };
+    
+    Type type;
+    float value;
 };
 //==============================================================================
 /**
 */
-class FlangerAudioProcessor  : public juce::AudioProcessor
+class FlangerAudioProcessor  : public juce::AudioProcessor,
+                               private DeferredAllocator::Client,
+                               private GovernorMonitor::Client
 {
 public:
     //==============================================================================
@@ -74,28 +160,177 @@ public:
     double mBlockSize;
     double mFeedbackGain;
     double mLfoFreqSliderValue;
-    atec::LFO::LfoType mLfoTypeComboBoxValue;
+    int mLfoType;
+    // the LFO setters and fields are written on the audio thread only, by applyCommand();
+    // other threads read them for display and change them with pushCommand()
     void setLfoFreq(double freq);
     void setLfoType(int type);
+    void setLfoMorph(float morph);
+    float getLfoMorph() const;
+    // message thread only; resamples numValues (0 to 1) into the user shape, false if the last one is still pending
+    bool setUserLfoShape(const float* values, int numValues);
+    // the points last passed to setUserLfoShape, so a reopened editor can show them; message thread only
+    const std::vector<float>& getUserLfoPoints() const;
     void setDepthTarget(double depth);
     double getDepthTarget();
-    int mRingBuffSize;
+    void setEcoMode(bool shouldUseEcoMode);
+    bool getEcoMode() const;
+    // linear (default) or cubic delay-line interpolation, picked up at the start of the next block
+    void setCubicInterpolation(bool shouldUseCubic);
+    bool getCubicInterpolation() const;
+    // the scope is only fed while an editor has it enabled; pop from the message thread only
+    void setScopeEnabled(bool shouldPublish);
+    bool popScopeSnapshot(ScopeSnapshot& snapshot);
+    // OSC remote control, off until a port is given
+    bool startOscControl(int port, const juce::String& bindAddress = "127.0.0.1");
+    void stopOscControl();
+    int getOscPort() const;
+    juce::String getOscBindAddress() const;
+    // queues a command for the audio thread; safe from any non-audio thread, returns false if full
+    bool pushCommand(const FlangerCommand& command);
+    // commands applied by the audio thread, and refused because the queue was full, since construction
+    int getNumCommandsApplied() const;
+    int getNumCommandsDropped() const;
+    // kills the delay tail without a click; the work is spread over the following blocks
+    void requestClear();
+    // whether the delay line has memory yet; it stays unallocated until audio arrives
+    bool isDelayLineAllocated() const;
+    // how far the sidechain envelope ducks the sweep depth and pushes the delay towards
+    // its maximum, 0 to 1 each; set through sidechainDepth / sidechainDelay commands
+    float getSidechainDepthAmount() const;
+    float getSidechainDelayAmount() const;
+    // CPU governor: the share of the buffer period processBlock may use before it steps
+    // down to a cheaper tier, 0 to turn it off. The tier and averaged load are published
+    // for the editor; the governor stays out of offline renders.
+    void setCpuBudget(float fraction);
+    float getCpuBudget() const;
+    int getGovernorTier() const;
+    float getGovernorLoad() const;
+    static juce::String getGovernorTierName(int tier);
+    // for stress testing: each block busy-waits this many times as long as it really
+    // took, emulating a slower machine whose cost still scales with the tier
+    void setInjectedLoad(float factor);
     juce::SmoothedValue<double, juce::ValueSmoothingTypes::Linear> mDelayTimeSamps[2];
-    bool mLfoFlag;
     bool mContraryMotionFlag;
     double slider;
     
 private:
     
+    void updateLfoRate();
+    void fillDelayTimes(int numLanes, int numSamples);
+    void fillDelayTimesEco(int numLanes, int numSamples);
+    void updateScope(int numLanes, int numSamples, float inputPeak, float outputPeak);
+    void applyCommand(const FlangerCommand& command);
+    void advanceClear(int numSamples);
+    void followSidechain(const juce::AudioBuffer<float>& sidechain, int start, int numLanes, int numSamples);
+    void resetSidechain();
+    void allocateDelayLine();
+    bool performDeferredAllocation() override;
+    void logGovernorTier() override;
+    void updateGovernor(juce::int64 startTicks, int numSamples);
+    
+    enum ClearState
+    {
+        clearIdle,
+        clearFadingOut,
+        clearZeroing,
+        clearFadingIn
+    };
+    
     int buffSize;
-    int mRingBuffWriteIdx;
     int delayBlock;
 
     //juce::AudioBufer<float> mRingbuf;
-    atec::RingBuffer mRingBuf;
-    atec::LFO mLfoArray[2];
+    // interleaved L/R delay line, both taps are read in the same pass
+    StereoDelayLine mDelayLine;
+    // the ring is only allocated once audio arrives, by the shared DeferredAllocator's
+    // timer; until it is ready the plugin passes the dry signal. The lock keeps
+    // allocation and release apart.
+    juce::SharedResourcePointer<DeferredAllocator> mDeferredAllocator;
+    juce::CriticalSection mDelayLineLock;
+    std::atomic<bool> mDelayLineReady { false };
+    std::atomic<bool> mDelayLineRequested { false };
+    int mDelayLineFrames;
+    // modulated delay time for each lane, one segment long
+    juce::AudioBuffer<float> mDelayTimeBlock;
+    WavetableLfo mLfoArray[2];
     juce::SmoothedValue<double, juce::ValueSmoothingTypes::Linear> mLfoDepth[2];
     double mMaxDelaySamps;
+    double mLfoFreqHz;
+    
+    // eco mode: requested from any thread, picked up at the start of the next block
+    std::atomic<bool> mEcoModeRequested { false };
+    bool mEcoModeActive;
+    // samples left in the current control period, its length, and the ramp each lane is on:
+    // where the period started, the step per sample and the last value written
+    int mEcoRemaining;
+    int mEcoStride;
+    float mEcoStart[2];
+    float mEcoValue[2];
+    float mEcoStep[2];
+    
+    SpscFifo<ScopeSnapshot, SCOPEFIFOSIZE> mScopeFifo;
+    std::atomic<bool> mScopeEnabled { false };
+    int mScopeCountdown;
+    float mScopeInputPeak;
+    float mScopeOutputPeak;
+    
+    // the spin lock only serialises producers; the audio thread pops without it
+    SpscFifo<FlangerCommand, COMMANDFIFOSIZE> mCommandFifo;
+    juce::SpinLock mCommandWriteLock;
+    std::atomic<int> mCommandsApplied { 0 };
+    std::atomic<int> mCommandsDropped { 0 };
+    FlangerOscReceiver mOscReceiver { *this };
+    
+    // tables shared by every instance in the process, fetched in prepareToPlay
+    juce::SharedResourcePointer<SharedTables> mSharedTables;
+    std::shared_ptr<const InterpolationTable> mInterpolationTable;
+    std::shared_ptr<const WaveTables> mWaveTables;
+    
+    // double-buffered user LFO shape: the message thread fills the spare one and
+    // publishes its index, the audio thread switches over at the next block
+    std::vector<float> mUserLfoTables[2];
+    std::atomic<int> mUserLfoPublished { -1 };
+    std::atomic<int> mUserLfoActive { -1 };
+    std::vector<float> mUserLfoPoints;
+    
+    // sidechain follower, audio thread only. It steps once per SIDECHAINSTRIDE samples
+    // counted from prepareToPlay, so the grid doesn't move with the host's block sizes:
+    // the peak so far and the samples left carry over from one call to the next. The
+    // modulation ramps from mSidechainRampStart to mSidechainEnvelope across each step.
+    // The coefficients are for one step and are worked out in prepareToPlay.
+    float mSidechainEnvelope;
+    float mSidechainRampStart;
+    float mSidechainPeak;
+    int mSidechainRemaining;
+    float mSidechainAttackCoeff;
+    float mSidechainReleaseCoeff;
+    float mSidechainDepthAmount;
+    float mSidechainDelayAmount;
+    
+    // governor state is audio thread only apart from the atomics. Tier changes are only
+    // published; the shared GovernorMonitor's timer polls and logs them
+    std::atomic<float> mCpuBudget { GOVERNORBUDGET };
+    std::atomic<float> mInjectedLoad { 0.0f };
+    std::atomic<int> mGovernorTierPublished { tierFull };
+    std::atomic<float> mGovernorLoadPublished { 0.0f };
+    juce::SharedResourcePointer<GovernorMonitor> mGovernorMonitor;
+    int mGovernorTierLogged;
+    int mGovernorTier;
+    double mGovernorLoad;
+    int mGovernorHeadroomSamples;
+    int mGovernorSettleSamples;
+    
+    // tail clear: requested from the UI, OSC, automation or a transport stop
+    std::atomic<bool> mClearRequested { false };
+    ClearState mClearState;
+    float mTapGain;
+    int mClearFrames;
+    juce::AudioParameterBool* mKillTailParam;
+    bool mKillTailWasOn;
+    bool mWasPlaying;
+    std::atomic<bool> mCubicRequested { false };
+    bool mCubicActive;
     //==============================================================================
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (FlangerAudioProcessor)
 };
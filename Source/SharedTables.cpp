@@ -0,0 +1,208 @@
+/*
+  ==============================================================================
+
+    SharedTables.cpp
+
+  ==============================================================================
+*/
+
+#include "SharedTables.h"
+
+//==============================================================================
+WaveTables::WaveTables (int size)
+    : tableSize (size)
+{
+    for (auto& table : shapes)
+        table.resize ((size_t) tableSize + 1);
+
+    // enough harmonics to keep the corners, and few enough that the table resolves each of them
+    auto numHarmonics = juce::jmin (WAVETABLEHARMONICS, tableSize / 4);
+
+    fillHarmonics (sine, 1);
+    fillHarmonics (saw, numHarmonics);
+    fillHarmonics (triangle, numHarmonics);
+    fillHarmonics (square, numHarmonics);
+
+    for (auto shape : { sine, saw, triangle, square })
+        normalise (shape);
+
+    for (int i = 0; i <= tableSize; i++)
+    {
+        // exponential rise and fall, continuous at the wrap
+        auto tri = shapes[triangle][(size_t) i];
+        shapes[exponential][(size_t) i] = (std::exp (4.0f * tri) - 1.0f) / (std::exp (4.0f) - 1.0f);
+    }
+
+    // smoothed sample & hold: 16 fixed random steps joined by raised-cosine segments
+    const int numSteps = 16;
+    float steps[numSteps];
+    juce::Random rng (0x5eed);
+
+    for (auto& step : steps)
+        step = rng.nextFloat();
+
+    for (int i = 0; i <= tableSize; i++)
+    {
+        auto position = (float) (i % tableSize) * (float) numSteps / (float) tableSize;
+        auto index = (int) position;
+        auto frac = 0.5f - 0.5f * std::cos (juce::MathConstants<float>::pi * (position - (float) index));
+
+        shapes[random][(size_t) i] = steps[index] + frac * (steps[(index + 1) % numSteps] - steps[index]);
+    }
+
+    normalise (random);
+}
+
+void WaveTables::fillHarmonics (Shape shape, int numHarmonics)
+{
+    auto& table = shapes[(size_t) shape];
+
+    for (int i = 0; i <= tableSize; i++)
+    {
+        auto phase = juce::MathConstants<double>::twoPi * (double) i / (double) tableSize;
+        double value = 0.0;
+
+        for (int k = 1; k <= numHarmonics; k++)
+        {
+            // Lanczos sigma factor tames the Gibbs ringing at the edges
+            auto sigma = k == 1 ? 1.0 : std::sin (juce::MathConstants<double>::pi * k / (numHarmonics + 1))
+                                        / (juce::MathConstants<double>::pi * k / (numHarmonics + 1));
+
+            switch (shape)
+            {
+                case sine:
+                    value += std::sin (phase);
+                    break;
+                case saw:
+                    value += sigma * std::sin (k * phase) / k;
+                    break;
+                case square:
+                    if (k % 2 == 1)
+                        value += sigma * std::sin (k * phase) / k;
+                    break;
+                case triangle:
+                    if (k % 2 == 1)
+                        value += ((k / 2) % 2 == 0 ? 1.0 : -1.0) * std::sin (k * phase) / (k * k);
+                    break;
+                default:
+                    break;
+            }
+        }
+
+        table[(size_t) i] = (float) value;
+    }
+}
+
+void WaveTables::normalise (Shape shape)
+{
+    auto& table = shapes[(size_t) shape];
+    auto range = juce::FloatVectorOperations::findMinAndMax (table.data(), (int) table.size());
+    auto scale = range.getLength() > 0.0f ? 1.0f / range.getLength() : 0.0f;
+
+    for (auto& value : table)
+        value = (value - range.getStart()) * scale;
+}
+
+size_t WaveTables::getSizeInBytes() const
+{
+    size_t bytes = sizeof (*this);
+
+    for (auto& table : shapes)
+        bytes += table.size() * sizeof (float);
+
+    return bytes;
+}
+
+//==============================================================================
+InterpolationTable::InterpolationTable (int steps)
+    : numSteps (steps)
+{
+    coefficients.resize (4 * ((size_t) numSteps + 1));
+
+    for (int i = 0; i <= numSteps; i++)
+    {
+        auto t = (float) i / (float) numSteps;
+        auto t2 = t * t;
+        auto t3 = t2 * t;
+        auto* c = coefficients.data() + 4 * i;
+
+        c[0] = -0.5f * t3 + t2 - 0.5f * t;
+        c[1] =  1.5f * t3 - 2.5f * t2 + 1.0f;
+        c[2] = -1.5f * t3 + 2.0f * t2 + 0.5f * t;
+        c[3] =  0.5f * t3 - 0.5f * t2;
+    }
+}
+
+size_t InterpolationTable::getSizeInBytes() const
+{
+    return sizeof (*this) + coefficients.size() * sizeof (float);
+}
+
+//==============================================================================
+SharedTables::SharedTables()
+{
+}
+
+SharedTables::~SharedTables()
+{
+}
+
+std::shared_ptr<const WaveTables> SharedTables::getWaveTables (int tableSize)
+{
+    const juce::ScopedLock lock (mLock);
+
+    auto& entry = mWaveTables[tableSize];
+    auto tables = entry.lock();
+
+    if (tables == nullptr)
+    {
+        tables = std::make_shared<const WaveTables> (tableSize);
+        entry = tables;
+    }
+
+    return tables;
+}
+
+std::shared_ptr<const InterpolationTable> SharedTables::getInterpolationTable (int numSteps)
+{
+    const juce::ScopedLock lock (mLock);
+
+    auto& entry = mInterpolationTables[numSteps];
+    auto table = entry.lock();
+
+    if (table == nullptr)
+    {
+        table = std::make_shared<const InterpolationTable> (numSteps);
+        entry = table;
+    }
+
+    return table;
+}
+
+juce::String SharedTables::getReport() const
+{
+    const juce::ScopedLock lock (mLock);
+    juce::String report;
+
+    auto describe = [&report] (const juce::String& name, size_t bytes, long users)
+    {
+        if (users == 0)
+            return;
+
+        report << name << ": " << (int) bytes << " bytes, " << (int) users << " users, "
+               << (int) (bytes * (size_t) (users - 1)) << " bytes saved ("
+               << (int) bytes << " per extra instance)" << juce::newLine;
+    };
+
+    for (auto& entry : mWaveTables)
+        if (auto tables = entry.second.lock())
+            describe ("Wave tables x " + juce::String (entry.first),
+                      tables->getSizeInBytes(), tables.use_count() - 1);
+
+    for (auto& entry : mInterpolationTables)
+        if (auto table = entry.second.lock())
+            describe ("Interpolation table x " + juce::String (entry.first),
+                      table->getSizeInBytes(), table.use_count() - 1);
+
+    return report;
+}
@@ -0,0 +1,100 @@
+/*
+  ==============================================================================
+
+    SharedTables.h
+
+    Process-wide, read-only lookup tables shared by every plugin instance.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#define WAVETABLESIZE 2048
+#define INTERPTABLESTEPS 1024
+// the edged shapes are built from this many harmonics so morphing never steps the delay time
+#define WAVETABLEHARMONICS 48
+
+//==============================================================================
+/** One cycle of each LFO waveform, unipolar (0 to 1), plus a guard point so
+    table[i + 1] is always valid. Nothing here depends on the sample rate: the
+    LFOs run far below Nyquist, so one set serves every rate.
+*/
+struct WaveTables
+{
+    enum Shape
+    {
+        sine,
+        saw,
+        triangle,
+        square,
+        exponential,
+        random,
+        numShapes
+    };
+
+    explicit WaveTables (int tableSize);
+
+    size_t getSizeInBytes() const;
+
+    const float* getShape (int shape) const noexcept { return shapes[(size_t) shape].data(); }
+
+    const int tableSize;
+    std::array<std::vector<float>, numShapes> shapes;
+
+private:
+    void fillHarmonics (Shape shape, int numHarmonics);
+    void normalise (Shape shape);
+};
+
+//==============================================================================
+/** 4-point Catmull-Rom coefficients for numSteps + 1 evenly spaced fractional
+    positions, stored as [c0 c1 c2 c3] per step so one read fetches all four.
+*/
+struct InterpolationTable
+{
+    explicit InterpolationTable (int numSteps);
+
+    size_t getSizeInBytes() const;
+
+    const float* getCoefficients (float frac) const noexcept
+    {
+        return coefficients.data() + 4 * (int) (frac * (float) numSteps + 0.5f);
+    }
+
+    const int numSteps;
+    std::vector<float> coefficients;
+};
+
+//==============================================================================
+/**
+    Reference-counted cache of the tables above. Hold it through a
+    juce::SharedResourcePointer<SharedTables>: the cache is created with the
+    first instance and destroyed with the last.
+
+    Tables are built lazily on first request, under a lock, and handed out as
+    shared_ptr<const ...>, so they are immutable and safe to read from any
+    thread. The cache keeps only weak references, so a table set nobody uses
+    any more is freed.
+*/
+class SharedTables
+{
+public:
+    SharedTables();
+    ~SharedTables();
+
+    std::shared_ptr<const WaveTables> getWaveTables (int tableSize);
+    std::shared_ptr<const InterpolationTable> getInterpolationTable (int numSteps);
+
+    /** Describes each live table, how many instances share it and the memory that saves. */
+    juce::String getReport() const;
+
+private:
+    juce::CriticalSection mLock;
+    std::map<int, std::weak_ptr<const WaveTables>> mWaveTables;
+    std::map<int, std::weak_ptr<const InterpolationTable>> mInterpolationTables;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SharedTables)
+};
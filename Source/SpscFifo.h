@@ -0,0 +1,66 @@
+/*
+  ==============================================================================
+
+    SpscFifo.h
+
+    Bounded single-producer / single-consumer queue for handing small POD
+    messages between the audio thread and another thread.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/**
+    Fixed-capacity FIFO built on juce::AbstractFifo.
+
+    push() and pop() are wait-free and never allocate, so either end may be the
+    audio thread. There must be exactly one producer thread and one consumer
+    thread. When the queue is full, push() drops the element and returns false.
+*/
+template <typename ElementType, int Capacity>
+class SpscFifo
+{
+public:
+    SpscFifo() : mFifo (Capacity) {}
+
+    bool push (const ElementType& element) noexcept
+    {
+        int start1, size1, start2, size2;
+        mFifo.prepareToWrite (1, start1, size1, start2, size2);
+
+        if (size1 == 0)
+            return false;
+
+        mItems[(size_t) start1] = element;
+        mFifo.finishedWrite (1);
+        return true;
+    }
+
+    bool pop (ElementType& element) noexcept
+    {
+        int start1, size1, start2, size2;
+        mFifo.prepareToRead (1, start1, size1, start2, size2);
+
+        if (size1 == 0)
+            return false;
+
+        element = mItems[(size_t) start1];
+        mFifo.finishedRead (1);
+        return true;
+    }
+
+    int getNumReady() const noexcept { return mFifo.getNumReady(); }
+
+    /** Discards everything queued. Only call this from the consumer thread. */
+    void clear() noexcept { mFifo.finishedRead (mFifo.getNumReady()); }
+
+private:
+    juce::AbstractFifo mFifo;
+    std::array<ElementType, (size_t) Capacity> mItems;
+
+    JUCE_DECLARE_NON_COPYABLE (SpscFifo)
+};
@@ -0,0 +1,190 @@
+/*
+  ==============================================================================
+
+    StereoDelayLine.cpp
+
+  ==============================================================================
+*/
+
+#include "StereoDelayLine.h"
+
+//==============================================================================
+StereoDelayLine::StereoDelayLine()
+    : mSize (0), mMask (0), mWritePos (0), mClearPos (0), mClearRemaining (0),
+      mClearLength (0), mFramesSinceClear (0)
+{
+}
+
+StereoDelayLine::~StereoDelayLine()
+{
+}
+
+void StereoDelayLine::setSize (int minNumFrames)
+{
+    mSize = juce::nextPowerOfTwo (juce::jmax (minNumFrames, 4));
+    mMask = mSize - 1;
+    mData.allocate ((size_t) (2 * (mSize + DELAYGUARDFRAMES)), true);
+    mWritePos = 0;
+    mClearRemaining = 0;
+}
+
+void StereoDelayLine::clear()
+{
+    if (mData != nullptr)
+        juce::FloatVectorOperations::clear (mData.get(), 2 * (mSize + DELAYGUARDFRAMES));
+
+    mWritePos = 0;
+    mClearRemaining = 0;
+}
+
+void StereoDelayLine::release()
+{
+    mData.free();
+    mSize = 0;
+    mMask = 0;
+    mWritePos = 0;
+    mClearRemaining = 0;
+}
+
+void StereoDelayLine::beginClear (int numFrames) noexcept
+{
+    mClearRemaining = juce::jlimit (0, mSize, numFrames);
+    mClearLength = mClearRemaining;
+    mClearPos = (mWritePos - mClearRemaining) & mMask;
+    mFramesSinceClear = 0;
+}
+
+bool StereoDelayLine::continueClear (int maxFrames) noexcept
+{
+    // The write head reaches the start of the region after mSize - mClearLength frames
+    // and then overwrites it oldest first, just like the zeroing does. Whatever it has
+    // written beyond the zeroing's progress is fresh audio, so skip over it.
+    auto numOverwritten = mFramesSinceClear - (mSize - mClearLength);
+    auto numCleared = mClearLength - mClearRemaining;
+
+    if (numOverwritten > numCleared)
+    {
+        auto numToSkip = juce::jmin (numOverwritten - numCleared, mClearRemaining);
+        mClearPos = (mClearPos + numToSkip) & mMask;
+        mClearRemaining -= numToSkip;
+    }
+
+    auto numToClear = juce::jmin (maxFrames, mClearRemaining);
+
+    while (numToClear > 0)
+    {
+        // at most two contiguous runs, split where the ring wraps
+        auto run = juce::jmin (numToClear, mSize - mClearPos);
+        juce::FloatVectorOperations::clear (mData.get() + 2 * mClearPos, 2 * run);
+
+        mClearPos = (mClearPos + run) & mMask;
+        mClearRemaining -= run;
+        numToClear -= run;
+    }
+
+    // keep the guard frames mirroring frames 0 .. DELAYGUARDFRAMES - 1
+    juce::FloatVectorOperations::copy (mData.get() + 2 * mSize, mData.get(), 2 * DELAYGUARDFRAMES);
+
+    return mClearRemaining == 0;
+}
+
+void StereoDelayLine::setInterpolationTable (std::shared_ptr<const InterpolationTable> table)
+{
+    mInterpolationTable = std::move (table);
+}
+
+//==============================================================================
+inline float StereoDelayLine::readLinear (int lane, float delay) const noexcept
+{
+    const float d = juce::jlimit (1.0f, (float) (mSize - 2), delay);
+    const int intPart = (int) d;
+    const float frac = d - (float) intPart;
+
+    // x[n - d] sits between frame n - int - 1 (older) and frame n - int (newer)
+    const int base = 2 * ((mWritePos - intPart - 1) & mMask) + lane;
+    const float older = mData[base];
+    const float newer = mData[base + 2];
+
+    return newer + frac * (older - newer);
+}
+
+inline float StereoDelayLine::readCubic (int lane, float delay) const noexcept
+{
+    // two frames of delay keep the newest of the four points already written
+    const float d = juce::jlimit (2.0f, (float) (mSize - 3), delay);
+    const int intPart = (int) d;
+    const float frac = d - (float) intPart;
+
+    // points n - int + 1 ... n - int - 2, read oldest first
+    const int base = 2 * ((mWritePos - intPart - 2) & mMask) + lane;
+    const float* c = mInterpolationTable->getCoefficients (frac);
+
+    return c[3] * mData[base] + c[2] * mData[base + 2]
+         + c[1] * mData[base + 4] + c[0] * mData[base + 6];
+}
+
+inline void StereoDelayLine::writeFrame (float left, float right) noexcept
+{
+    mData[2 * mWritePos]     = left;
+    mData[2 * mWritePos + 1] = right;
+
+    if (mWritePos < DELAYGUARDFRAMES)
+    {
+        mData[2 * (mSize + mWritePos)]     = left;
+        mData[2 * (mSize + mWritePos) + 1] = right;
+    }
+
+    mWritePos = (mWritePos + 1) & mMask;
+}
+
+void StereoDelayLine::process (const float* delayL, const float* delayR,
+                               float* ioL, float* ioR, int numFrames, float gainStart, float gainEnd) noexcept
+{
+    const float gainStep = numFrames > 0 ? (gainEnd - gainStart) / (float) numFrames : 0.0f;
+
+    // only counted while a clear is pending, so it can't overflow
+    if (mClearRemaining > 0)
+        mFramesSinceClear += numFrames;
+
+    if (mInterpolationTable != nullptr)
+        processFrames<true> (delayL, delayR, ioL, ioR, numFrames, gainStart, gainStep);
+    else
+        processFrames<false> (delayL, delayR, ioL, ioR, numFrames, gainStart, gainStep);
+}
+
+template <bool useCubic>
+void StereoDelayLine::processFrames (const float* delayL, const float* delayR,
+                                     float* ioL, float* ioR, int numFrames, float gainStart, float gainStep) noexcept
+{
+    auto read = [this] (int lane, float delay)
+    {
+        return useCubic ? readCubic (lane, delay) : readLinear (lane, delay);
+    };
+
+    if (ioR == nullptr)
+    {
+        for (int i = 0; i < numFrames; ++i)
+        {
+            const float gain = gainStart + gainStep * (float) (i + 1);
+            const float outL = ioL[i] + gain * read (0, delayL[i]);
+
+            ioL[i] = outL;
+            writeFrame (outL, outL);
+        }
+
+        return;
+    }
+
+    // Both lanes go through the same arithmetic in the same iteration, and in
+    // sync motion the two reads hit the same pair of frames.
+    for (int i = 0; i < numFrames; ++i)
+    {
+        const float gain = gainStart + gainStep * (float) (i + 1);
+        const float outL = ioL[i] + gain * read (0, delayL[i]);
+        const float outR = ioR[i] + gain * read (1, delayR[i]);
+
+        ioL[i] = outL;
+        ioR[i] = outR;
+        writeFrame (outL, outR);
+    }
+}
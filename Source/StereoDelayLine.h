@@ -0,0 +1,97 @@
+/*
+  ==============================================================================
+
+    StereoDelayLine.h
+
+    Fractional delay line that stores left and right frame-interleaved, so
+    both channels' taps are computed together in one pass.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "SharedTables.h"
+
+// frames mirrored past the end so a 4-point read never has to wrap
+#define DELAYGUARDFRAMES 3
+
+//==============================================================================
+/**
+    Two-channel ring buffer laid out as [L0 R0 L1 R1 ...].
+
+    A fractional read for the left and right tap of the same frame lands in
+    the same cache line (and in sync motion, the same two frames), instead of
+    walking two separate per-channel streams. The size is rounded up to a power
+    of two so wraparound is a single mask, and guard frames mirroring the first
+    few frames let the interpolator read past the end without a branch.
+
+    Taps are linearly interpolated, or 4-point cubic when an interpolation
+    table is set. Each frame's taps are read before that frame is written, and
+    delays are clamped so a read never reaches an unwritten frame, so the
+    output never depends on how the host splits its buffers.
+*/
+class StereoDelayLine
+{
+public:
+    StereoDelayLine();
+    ~StereoDelayLine();
+
+    /** Allocates at least minNumFrames frames and clears them. Not realtime safe. */
+    void setSize (int minNumFrames);
+    void clear();
+
+    /** Frees the frames; setSize() has to be called again before the next process(). */
+    void release();
+
+    int getSize() const noexcept { return mSize; }
+
+    /** Switches to cubic interpolation using the given shared coefficients,
+        or back to linear when passed nullptr.
+    */
+    void setInterpolationTable (std::shared_ptr<const InterpolationTable> table);
+
+    /** Runs the feedback comb in place: for each frame, reads one interpolated tap per lane
+        delayL[i] / delayR[i] frames back, replaces the sample with
+        sample + gain * tap and writes the result. The gain ramps linearly from
+        gainStart to gainEnd across the call.
+        Pass nullptr for ioR to run mono; lane R then mirrors lane L.
+    */
+    void process (const float* delayL, const float* delayR,
+                  float* ioL, float* ioR, int numFrames, float gainStart, float gainEnd) noexcept;
+
+    /** Marks the numFrames most recent frames for zeroing. Nothing older than
+        the longest tap can be read again, so that is all a clear has to touch.
+        The work is done by continueClear() so it can be spread across callbacks.
+    */
+    void beginClear (int numFrames) noexcept;
+
+    /** Zeroes up to maxFrames of the pending region, oldest first, and returns
+        true once the whole region is clear. Frames process() has written since
+        beginClear() are never zeroed: once the write head wraps round into the
+        region, the part it has reached counts as cleared.
+    */
+    bool continueClear (int maxFrames) noexcept;
+
+private:
+    template <bool useCubic>
+    void processFrames (const float* delayL, const float* delayR,
+                        float* ioL, float* ioR, int numFrames, float gainStart, float gainStep) noexcept;
+
+    float readLinear (int lane, float delay) const noexcept;
+    float readCubic (int lane, float delay) const noexcept;
+    void writeFrame (float left, float right) noexcept;
+
+    juce::HeapBlock<float> mData;   // 2 * (mSize + DELAYGUARDFRAMES) floats
+    std::shared_ptr<const InterpolationTable> mInterpolationTable;
+    int mSize;
+    int mMask;
+    int mWritePos;
+    int mClearPos;
+    int mClearRemaining;
+    int mClearLength;
+    int mFramesSinceClear;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (StereoDelayLine)
+};
@@ -0,0 +1,278 @@
+/*
+  ==============================================================================
+
+    BlockSizeTests.cpp
+
+    Host block sizes: the per-sample cost from 1-sample automation blocks up to
+    offline-render blocks far larger than the size the processor was prepared
+    with, and that the output doesn't depend on how the host splits the audio.
+    Also the interleaved delay line against the per-channel ring it replaced.
+
+  ==============================================================================
+*/
+
+#include "FlangerTestUtilities.h"
+#include "../StereoDelayLine.h"
+
+#if FLANGER_UNIT_TESTS
+
+//==============================================================================
+class BlockSizeTests  : public juce::UnitTest
+{
+public:
+    BlockSizeTests()  : juce::UnitTest ("Block sizes", "Flanger") {}
+
+    void runTest() override
+    {
+        beginTest ("Per-sample cost at 1, 16, 64 and 8192-sample blocks");
+
+        const double sampleRate = 48000.0;
+        const int numSamples = 10 * (int) sampleRate;
+        const int blockSizes[] = { 1, 16, 64, 8192 };
+        double nanosPerSample[4];
+
+        juce::AudioBuffer<float> input (2, numSamples), buffer (2, numSamples);
+        FlangerTestUtilities::fillWithNoise (input, 1);
+
+        for (int i = 0; i < 4; i++)
+        {
+            // prepared for 512, so the 8192-sample blocks are larger than advertised
+            FlangerAudioProcessor processor;
+            processor.setNonRealtime (true);
+            FlangerTestUtilities::prepare (processor, sampleRate, 512);
+
+            // a first pass allocates the delay line and warms the caches
+            buffer.makeCopyOf (input, true);
+            FlangerTestUtilities::processInBlocks (processor, buffer, blockSizes[i]);
+
+            buffer.makeCopyOf (input, true);
+            auto allocations = FlangerTestUtilities::getAllocationCount();
+            auto seconds = FlangerTestUtilities::processInBlocks (processor, buffer, blockSizes[i]);
+
+            expectEquals (FlangerTestUtilities::getAllocationCount() - allocations, 0,
+                          "processBlock allocated at " + juce::String (blockSizes[i]) + "-sample blocks");
+
+            nanosPerSample[i] = 1.0e9 * seconds / numSamples;
+
+            logMessage (juce::String (blockSizes[i]).paddedLeft (' ', 5) + "-sample blocks: "
+                        + juce::String (nanosPerSample[i], 1) + " ns/sample, "
+                        + juce::String (numSamples / sampleRate / seconds, 0) + "x realtime, "
+                        + juce::String (nanosPerSample[i] / nanosPerSample[3], 2) + "x the 8192-sample cost");
+        }
+
+        // the per-block work (command queue, bus views, governor) is small next to 64 samples
+        expectLessThan (nanosPerSample[2], 2.0 * nanosPerSample[3], "64-sample blocks cost too much more than 8192");
+
+        beginTest ("One 32768-sample block matches the same audio in 1 and 64-sample blocks");
+
+        for (auto mode : { audioRate, eco, sidechain })
+        {
+            auto whole = render (mode, 32768);
+
+            for (auto blockSize : { 1, 64 })
+            {
+                auto split = render (mode, blockSize);
+                int numDifferent = 0;
+
+                for (int channel = 0; channel < 2; channel++)
+                    for (int i = 0; i < whole.getNumSamples(); i++)
+                        if (whole.getSample (channel, i) != split.getSample (channel, i))
+                            numDifferent++;
+
+                expectEquals (numDifferent, 0, getModeName (mode) + " differs in " + juce::String (blockSize) + "-sample blocks");
+            }
+        }
+
+        beginTest ("Throughput doesn't fall as the host block grows");
+
+        const int blockSizesToCompare[] = { 512, 32768 };
+        double secondsPerSize[2];
+
+        for (int i = 0; i < 2; i++)
+        {
+            FlangerAudioProcessor processor;
+            processor.setNonRealtime (true);
+            FlangerTestUtilities::prepare (processor, sampleRate, 512);
+
+            buffer.makeCopyOf (input, true);
+            FlangerTestUtilities::processInBlocks (processor, buffer, blockSizesToCompare[i]);
+
+            buffer.makeCopyOf (input, true);
+            secondsPerSize[i] = FlangerTestUtilities::processInBlocks (processor, buffer, blockSizesToCompare[i]);
+        }
+
+        logMessage ("32768-sample blocks take " + juce::String (secondsPerSize[1] / secondsPerSize[0], 2)
+                    + "x as long as 512-sample blocks");
+
+        // the tiles are the same size either way, so only the per-block overhead differs
+        expectLessThan (secondsPerSize[1], 1.25 * secondsPerSize[0], "large host blocks are slower per sample");
+
+        beginTest ("Interleaved delay line against the per-channel atec::RingBuffer");
+
+        // the same swept taps and feedback gain through each, at 64-sample blocks
+        auto ringSeconds = timeRingBuffer (input, sampleRate);
+        auto interleavedSeconds = timeInterleaved (input, sampleRate);
+
+        logMessage ("per-channel atec::RingBuffer " + juce::String (1.0e9 * ringSeconds / numSamples, 1)
+                    + " ns/sample, interleaved StereoDelayLine " + juce::String (1.0e9 * interleavedSeconds / numSamples, 1)
+                    + " ns/sample, " + juce::String (interleavedSeconds / ringSeconds, 2) + "x");
+
+        expectLessThan (interleavedSeconds, ringSeconds, "the interleaved delay line is no faster than the two-loop ring buffer");
+    }
+
+private:
+    static constexpr int delayBlockSize = 64;
+    static constexpr int delayTableSize = 4096;
+
+    // Tap delays for both lanes, swept in contrary motion across most of the
+    // flanger's range. One cycle is a whole number of blocks, so block n reads
+    // from (n * delayBlockSize) % delayTableSize without wrapping inside a block.
+    static std::vector<float> makeDelayTable (double sampleRate, int lane)
+    {
+        auto maxDelay = MAXDELAYTIME * sampleRate;
+        std::vector<float> delays ((size_t) delayTableSize);
+
+        for (int i = 0; i < delayTableSize; i++)
+        {
+            auto phase = (double) i / delayTableSize + 0.5 * lane;
+            delays[(size_t) i] = (float) (maxDelay * (0.5 + 0.49 * std::sin (juce::MathConstants<double>::twoPi * phase)));
+        }
+
+        return delays;
+    }
+
+    template <typename ProcessBlock>
+    static double timeBestOfThree (const juce::AudioBuffer<float>& input, ProcessBlock&& processBlock)
+    {
+        juce::AudioBuffer<float> buffer (2, input.getNumSamples());
+        auto best = 1.0e9;
+
+        // the first run warms the caches and isn't counted
+        for (int run = 0; run < 4; run++)
+        {
+            buffer.makeCopyOf (input, true);
+            auto start = juce::Time::getHighResolutionTicks();
+
+            for (int pos = 0; pos + delayBlockSize <= buffer.getNumSamples(); pos += delayBlockSize)
+                processBlock (buffer, pos);
+
+            auto seconds = juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - start);
+
+            if (run > 0)
+                best = juce::jmin (best, seconds);
+        }
+
+        return best;
+    }
+
+    /** The path the processor had before: each channel's taps read in a loop of its own
+        into a scratch block, scaled, added, then the whole block written to the ring.
+        The ring is the 3 seconds the processor allocated.
+    */
+    static double timeRingBuffer (const juce::AudioBuffer<float>& input, double sampleRate)
+    {
+        std::vector<float> delays[2] = { makeDelayTable (sampleRate, 0), makeDelayTable (sampleRate, 1) };
+
+        atec::RingBuffer ring;
+        ring.setSize (2, (int) (3.0 * sampleRate), delayBlockSize);
+        ring.init();
+
+        juce::AudioBuffer<float> delayBlock (2, delayBlockSize);
+
+        return timeBestOfThree (input, [&] (juce::AudioBuffer<float>& buffer, int pos)
+        {
+            juce::AudioBuffer<float> block (buffer.getArrayOfWritePointers(), 2, pos, delayBlockSize);
+            auto offset = pos % delayTableSize;
+
+            for (int channel = 0; channel < 2; channel++)
+            {
+                auto* delayBlockPtr = delayBlock.getWritePointer (channel);
+
+                for (int i = 0; i < delayBlockSize; i++)
+                    delayBlockPtr[i] = ring.readInterpSample (channel, i, delays[channel][(size_t) (offset + i)]);
+
+                delayBlock.applyGain (channel, 0, delayBlockSize, (float) FEEDBACKGAININIT);
+                block.addFrom (channel, 0, delayBlock, channel, 0, delayBlockSize);
+            }
+
+            ring.write (block);
+        });
+    }
+
+    /** Both lanes' taps, mix and write in one pass over frame-interleaved storage,
+        linear like the ring buffer, sized to the longest tap as the processor does.
+    */
+    static double timeInterleaved (const juce::AudioBuffer<float>& input, double sampleRate)
+    {
+        std::vector<float> delays[2] = { makeDelayTable (sampleRate, 0), makeDelayTable (sampleRate, 1) };
+
+        StereoDelayLine delayLine;
+        delayLine.setSize ((int) std::ceil (MAXDELAYTIME * sampleRate) + DELAYGUARDFRAMES + 2);
+
+        return timeBestOfThree (input, [&] (juce::AudioBuffer<float>& buffer, int pos)
+        {
+            auto offset = (size_t) (pos % delayTableSize);
+
+            delayLine.process (delays[0].data() + offset, delays[1].data() + offset,
+                               buffer.getWritePointer (0, pos), buffer.getWritePointer (1, pos),
+                               delayBlockSize, (float) FEEDBACKGAININIT, (float) FEEDBACKGAININIT);
+        });
+    }
+
+    enum Mode
+    {
+        audioRate,
+        eco,
+        sidechain
+    };
+
+    static juce::String getModeName (Mode mode)
+    {
+        switch (mode)
+        {
+            case eco:       return "Eco mode";
+            case sidechain: return "Sidechain";
+            default:        return "Audio rate";
+        }
+    }
+
+    /** Three seconds of noise through a fresh instance, returning the main output. */
+    static juce::AudioBuffer<float> render (Mode mode, int blockSize)
+    {
+        const double sampleRate = 48000.0;
+        const int numSamples = 3 * 48000;
+
+        FlangerAudioProcessor processor;
+
+        // offline, so the delay line is there from the first block and the governor stays out of it
+        processor.setNonRealtime (true);
+        processor.setEcoMode (mode == eco);
+        FlangerTestUtilities::prepare (processor, sampleRate, 512, mode == sidechain);
+
+        if (mode == sidechain)
+        {
+            processor.pushCommand ({ FlangerCommand::sidechainDepth, 0.7f });
+            processor.pushCommand ({ FlangerCommand::sidechainDelay, 0.4f });
+        }
+
+        juce::AudioBuffer<float> buffer (processor.getTotalNumInputChannels(), numSamples);
+        FlangerTestUtilities::fillWithNoise (buffer, 2);
+
+        // bursts on the sidechain, 1234 samples on and off so its edges land all over the blocks
+        for (int channel = 2; channel < buffer.getNumChannels(); channel++)
+            for (int i = 0; i < numSamples; i++)
+                if ((i / 1234) % 2 == 1)
+                    buffer.setSample (channel, i, 0.0f);
+
+        FlangerTestUtilities::processInBlocks (processor, buffer, blockSize);
+
+        juce::AudioBuffer<float> output (2, numSamples);
+        output.copyFrom (0, 0, buffer, 0, 0, numSamples);
+        output.copyFrom (1, 0, buffer, 1, 0, numSamples);
+        return output;
+    }
+};
+
+static BlockSizeTests blockSizeTests;
+
+#endif
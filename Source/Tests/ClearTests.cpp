@@ -0,0 +1,127 @@
+/*
+  ==============================================================================
+
+    ClearTests.cpp
+
+    The tail clear: what the spread-out zeroing may and may not touch, and that
+    a clear leaves nothing behind whatever the host block size.
+
+  ==============================================================================
+*/
+
+#include "FlangerTestUtilities.h"
+#include "../StereoDelayLine.h"
+
+#if FLANGER_UNIT_TESTS
+
+//==============================================================================
+class ClearTests  : public juce::UnitTest
+{
+public:
+    ClearTests()  : juce::UnitTest ("Tail clear", "Flanger") {}
+
+    void runTest() override
+    {
+        beginTest ("Zeroing never touches frames written after the clear began");
+
+        // the processor's proportions at 48 kHz: a 1204-frame region in a 2048-frame ring
+        const int clearFrames = 1204;
+
+        // the old fixed rate, slower than a 512-sample tile writes, leans on the overlap check alone
+        checkZeroing (clearFrames, 512, 256);
+
+        for (auto tileSize : { 64, 300, 512 })
+            checkZeroing (clearFrames, tileSize, CLEARFRAMESPERSAMPLE * tileSize);
+
+        beginTest ("A clear leaves the tail silent at any block size");
+
+        for (auto blockSize : { 64, 512 })
+            checkProcessorClear (blockSize);
+    }
+
+private:
+    static void writeFrames (StereoDelayLine& delayLine, float value, int numFrames)
+    {
+        std::vector<float> left ((size_t) numFrames, value), right ((size_t) numFrames, value);
+        std::vector<float> delays ((size_t) numFrames, 1.0f);
+
+        // no feedback, so the frames written are exactly the input
+        delayLine.process (delays.data(), delays.data(), left.data(), right.data(), numFrames, 0.0f, 0.0f);
+    }
+
+    void checkZeroing (int clearFrames, int tileSize, int framesPerTile)
+    {
+        StereoDelayLine delayLine;
+        delayLine.setSize (clearFrames + 1);
+        auto size = delayLine.getSize();
+
+        // old audio everywhere, then fresh audio while the clear runs in tiles
+        writeFrames (delayLine, 1.0f, 2 * size);
+
+        delayLine.beginClear (clearFrames);
+        int numWritten = 0;
+        bool done = false;
+
+        while (! done)
+        {
+            done = delayLine.continueClear (framesPerTile);
+            writeFrames (delayLine, 2.0f, tileSize);
+            numWritten += tileSize;
+        }
+
+        // Read the newest size - 2 frames back, oldest first: one integer tap
+        // numToRead frames long, no input and unity gain, so each output sample
+        // is a stored frame. Nothing read is overwritten before it's read.
+        auto numToRead = size - 2;
+        std::vector<float> left ((size_t) numToRead, 0.0f), right ((size_t) numToRead, 0.0f);
+        std::vector<float> delays ((size_t) numToRead, (float) numToRead);
+        delayLine.process (delays.data(), delays.data(), left.data(), right.data(), numToRead, 1.0f, 1.0f);
+
+        int numWrong = 0;
+
+        for (int i = 0; i < numToRead; i++)
+        {
+            // frames before the clear began count negative
+            auto age = i - (numToRead - numWritten);
+            auto expected = age >= 0 ? 2.0f : (age >= -clearFrames ? 0.0f : 1.0f);
+
+            if (left[(size_t) i] != expected)
+                numWrong++;
+        }
+
+        expectEquals (numWrong, 0, juce::String (tileSize) + "-frame tiles zeroing " + juce::String (framesPerTile)
+                                   + " frames each: wrong frames after the clear");
+    }
+
+    void checkProcessorClear (int blockSize)
+    {
+        const double sampleRate = 48000.0;
+
+        FlangerAudioProcessor processor;
+        processor.setNonRealtime (true);
+        FlangerTestUtilities::prepare (processor, sampleRate, blockSize);
+
+        // a second of noise builds up a tail through the feedback path
+        juce::AudioBuffer<float> buffer (2, (int) sampleRate);
+        FlangerTestUtilities::fillWithNoise (buffer, 7);
+        FlangerTestUtilities::processInBlocks (processor, buffer, blockSize);
+
+        // then silence in, so whatever comes out is tail; it takes far longer than the clear to decay
+        processor.requestClear();
+        buffer.clear();
+        FlangerTestUtilities::processInBlocks (processor, buffer, blockSize);
+        expectGreaterThan (buffer.getMagnitude (0, blockSize), 0.0f, "no tail to clear");
+
+        // Fade out, zero at CLEARFRAMESPERSAMPLE frames per sample, fade back in; each
+        // stage can run over by a block. Everything after that has to be silent.
+        auto clearFrames = (int) std::ceil (MAXDELAYTIME * sampleRate) + DELAYGUARDFRAMES + 1;
+        auto clearSamples = 2 * CLEARFADESAMPLES + clearFrames / CLEARFRAMESPERSAMPLE + 3 * blockSize;
+        auto tail = buffer.getMagnitude (clearSamples, buffer.getNumSamples() - clearSamples);
+
+        expectEquals (tail, 0.0f, "the tail survived a clear at " + juce::String (blockSize) + "-sample blocks");
+    }
+};
+
+static ClearTests clearTests;
+
+#endif
@@ -0,0 +1,107 @@
+/*
+  ==============================================================================
+
+    FlangerTestUtilities.cpp
+
+  ==============================================================================
+*/
+
+#include "FlangerTestUtilities.h"
+
+#if FLANGER_UNIT_TESTS
+
+#include <new>
+#include <cstdlib>
+#include <fstream>
+
+#if JUCE_LINUX
+ #include <unistd.h>
+#endif
+
+//==============================================================================
+// Counts every allocation per thread, so a test can check that processBlock
+// never allocates. Only the Tests configuration replaces operator new, and
+// its plugin binaries aren't meant to be loaded into a host.
+static thread_local int allocationsOnThisThread = 0;
+
+void* operator new (std::size_t size)
+{
+    ++allocationsOnThisThread;
+
+    if (auto* memory = std::malloc (size > 0 ? size : 1))
+        return memory;
+
+    throw std::bad_alloc();
+}
+
+void* operator new[] (std::size_t size)
+{
+    return operator new (size);
+}
+
+void operator delete (void* memory) noexcept                { std::free (memory); }
+void operator delete[] (void* memory) noexcept              { std::free (memory); }
+void operator delete (void* memory, std::size_t) noexcept   { std::free (memory); }
+void operator delete[] (void* memory, std::size_t) noexcept { std::free (memory); }
+
+//==============================================================================
+void FlangerTestUtilities::prepare (FlangerAudioProcessor& processor, double sampleRate, int blockSize, bool withSidechain)
+{
+    auto layout = processor.getBusesLayout();
+    layout.inputBuses.getReference (1) = withSidechain ? juce::AudioChannelSet::stereo()
+                                                       : juce::AudioChannelSet::disabled();
+    processor.setBusesLayout (layout);
+
+    processor.setRateAndBufferSizeDetails (sampleRate, blockSize);
+    processor.prepareToPlay (sampleRate, blockSize);
+}
+
+void FlangerTestUtilities::fillWithNoise (juce::AudioBuffer<float>& buffer, juce::int64 seed, float gain)
+{
+    juce::Random random (seed);
+
+    for (int channel = 0; channel < buffer.getNumChannels(); channel++)
+    {
+        auto* data = buffer.getWritePointer (channel);
+
+        for (int i = 0; i < buffer.getNumSamples(); i++)
+            data[i] = gain * (2.0f * random.nextFloat() - 1.0f);
+    }
+}
+
+double FlangerTestUtilities::processInBlocks (FlangerAudioProcessor& processor, juce::AudioBuffer<float>& buffer, int blockSize)
+{
+    juce::MidiBuffer midi;
+    auto startTicks = juce::Time::getHighResolutionTicks();
+
+    for (int start = 0; start < buffer.getNumSamples(); start += blockSize)
+    {
+        // a view onto the buffer, so nothing is copied or allocated per block
+        juce::AudioBuffer<float> block (buffer.getArrayOfWritePointers(), buffer.getNumChannels(),
+                                        start, juce::jmin (blockSize, buffer.getNumSamples() - start));
+        processor.processBlock (block, midi);
+    }
+
+    return juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - startTicks);
+}
+
+int FlangerTestUtilities::getAllocationCount() noexcept
+{
+    return allocationsOnThisThread;
+}
+
+juce::int64 FlangerTestUtilities::getResidentBytes()
+{
+   #if JUCE_LINUX
+    // the second field is the resident page count
+    std::ifstream statm ("/proc/self/statm");
+    juce::int64 totalPages = 0, residentPages = 0;
+
+    if (statm >> totalPages >> residentPages)
+        return residentPages * (juce::int64) sysconf (_SC_PAGESIZE);
+   #endif
+
+    return 0;
+}
+
+#endif
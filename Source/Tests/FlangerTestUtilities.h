@@ -0,0 +1,43 @@
+/*
+  ==============================================================================
+
+    FlangerTestUtilities.h
+
+    Shared set-up for the unit tests and benchmarks in this folder. They are
+    only compiled into the Tests configuration (FLANGER_UNIT_TESTS=1), which
+    is optimised like Release, and are run with
+
+        Flanger --test [test name]
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "../PluginProcessor.h"
+
+#if FLANGER_UNIT_TESTS
+
+namespace FlangerTestUtilities
+{
+    /** Prepares the processor the way a host would: stereo in and out, plus a
+        stereo sidechain if asked for. Buffers then need getTotalNumInputChannels().
+    */
+    void prepare (FlangerAudioProcessor& processor, double sampleRate, int blockSize, bool withSidechain = false);
+
+    void fillWithNoise (juce::AudioBuffer<float>& buffer, juce::int64 seed, float gain = 0.5f);
+
+    /** Runs the buffer through processBlock in place, blockSize samples at a time
+        (the last block may be shorter), and returns the wall-clock seconds taken.
+    */
+    double processInBlocks (FlangerAudioProcessor& processor, juce::AudioBuffer<float>& buffer, int blockSize);
+
+    /** How many times operator new has been called on the calling thread so far. */
+    int getAllocationCount() noexcept;
+
+    /** The process's resident set size in bytes, or 0 where it can't be read. */
+    juce::int64 getResidentBytes();
+}
+
+#endif
@@ -0,0 +1,145 @@
+/*
+  ==============================================================================
+
+    GovernorTests.cpp
+
+    Deadline misses under emulated overload, with and without the CPU governor.
+
+  ==============================================================================
+*/
+
+#include "FlangerTestUtilities.h"
+
+#if FLANGER_UNIT_TESTS
+
+//==============================================================================
+class GovernorTests  : public juce::UnitTest
+{
+public:
+    GovernorTests()  : juce::UnitTest ("CPU governor", "Flanger") {}
+
+    void runTest() override
+    {
+        beginTest ("Governor reduces deadline misses under injected load");
+
+        juce::AudioBuffer<float> source (2, blockSize);
+        FlangerTestUtilities::fillWithNoise (source, 5);
+
+        // The full tier's cost per block on this machine, ungoverned and unloaded.
+        // The governor's budget is a share of the buffer period, so the sample rate
+        // sets how tight the deadline is: pick one where the full tier with the
+        // injected load overruns the period by a quarter.
+        auto blockSeconds = measureFullTierBlock (source);
+        auto loadedSeconds = blockSeconds * (1.0 + injectedLoad);
+        auto sampleRate = juce::jlimit (8000.0, 3.2e7, blockSize / (loadedSeconds / overrun));
+        auto periodSeconds = blockSize / sampleRate;
+
+        logMessage ("full tier " + juce::String (1.0e6 * blockSeconds, 2) + " us per " + juce::String (blockSize)
+                    + "-sample block, " + juce::String (1.0e6 * loadedSeconds, 2) + " us loaded; running at "
+                    + juce::String (sampleRate / 1000.0, 0) + " kHz, a " + juce::String (1.0e6 * periodSeconds, 2) + " us period");
+
+        int finalTier = 0;
+        auto ungovernedMisses = countDeadlineMisses (source, sampleRate, 0.0f, finalTier);
+        auto governedMisses = countDeadlineMisses (source, sampleRate, (float) GOVERNORBUDGET, finalTier);
+
+        logMessage ("deadline misses in " + juce::String (numBlocks) + " blocks: ungoverned "
+                    + juce::String (ungovernedMisses) + ", governed " + juce::String (governedMisses)
+                    + " (settled in the " + FlangerAudioProcessor::getGovernorTierName (finalTier) + " tier)");
+
+        expectGreaterThan (ungovernedMisses, 0, "the injected load never overran the period");
+        expectLessThan ((double) governedMisses, 0.75 * ungovernedMisses, "the governor didn't reduce deadline misses");
+        expectGreaterThan (finalTier, (int) tierFull, "the governor never stepped down");
+    }
+
+private:
+    static constexpr int blockSize = 512;
+    static constexpr int numBlocks = 20000;
+    static constexpr float injectedLoad = 3.0f;
+    static constexpr double overrun = 1.25;
+
+    // realtime, like a host's audio thread: the governor stays out of offline renders
+    static void prepareRealtime (FlangerAudioProcessor& processor, double sampleRate, float budget)
+    {
+        processor.setCubicInterpolation (true);
+        processor.setCpuBudget (budget);
+        FlangerTestUtilities::prepare (processor, sampleRate, blockSize);
+    }
+
+    // The first non-silent block asks the DeferredAllocator's timer for the ring.
+    // The runner keeps the message loop going, so it arrives within a few ticks.
+    bool waitForDelayLine (FlangerAudioProcessor& processor, const juce::AudioBuffer<float>& source)
+    {
+        juce::AudioBuffer<float> buffer (source);
+        juce::MidiBuffer midi;
+        processor.processBlock (buffer, midi);
+
+        for (int i = 0; i < 200 && ! processor.isDelayLineAllocated(); i++)
+            juce::Thread::sleep (10);
+
+        auto allocated = processor.isDelayLineAllocated();
+        expect (allocated, "the delay line was never allocated");
+        return allocated;
+    }
+
+    double measureFullTierBlock (const juce::AudioBuffer<float>& source)
+    {
+        FlangerAudioProcessor processor;
+        prepareRealtime (processor, 48000.0, 0.0f);
+
+        if (! waitForDelayLine (processor, source))
+            return 0.0;
+
+        juce::AudioBuffer<float> buffer (2, blockSize);
+        juce::MidiBuffer midi;
+        std::vector<double> seconds;
+
+        for (int i = 0; i < 2000; i++)
+        {
+            buffer.makeCopyOf (source, true);
+
+            auto start = juce::Time::getHighResolutionTicks();
+            processor.processBlock (buffer, midi);
+            seconds.push_back (juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - start));
+        }
+
+        // the median, so preempted blocks don't skew it
+        std::nth_element (seconds.begin(), seconds.begin() + (long) seconds.size() / 2, seconds.end());
+        return seconds[seconds.size() / 2];
+    }
+
+    int countDeadlineMisses (const juce::AudioBuffer<float>& source, double sampleRate, float budget, int& finalTier)
+    {
+        FlangerAudioProcessor processor;
+        prepareRealtime (processor, sampleRate, budget);
+
+        if (! waitForDelayLine (processor, source))
+            return 0;
+
+        processor.setInjectedLoad (injectedLoad);
+
+        juce::AudioBuffer<float> buffer (2, blockSize);
+        juce::MidiBuffer midi;
+        auto periodTicks = (juce::int64) (juce::Time::getHighResolutionTicksPerSecond() * blockSize / sampleRate);
+        int misses = 0;
+
+        for (int i = 0; i < numBlocks; i++)
+        {
+            // fresh input every block, so the feedback path never decays into denormals
+            buffer.makeCopyOf (source, true);
+
+            auto start = juce::Time::getHighResolutionTicks();
+            processor.processBlock (buffer, midi);
+
+            if (juce::Time::getHighResolutionTicks() - start > periodTicks)
+                misses++;
+        }
+
+        finalTier = processor.getGovernorTier();
+        processor.releaseResources();
+        return misses;
+    }
+};
+
+static GovernorTests governorTests;
+
+#endif
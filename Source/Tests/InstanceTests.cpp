@@ -0,0 +1,82 @@
+/*
+  ==============================================================================
+
+    InstanceTests.cpp
+
+    What a session full of idle instances costs in time and memory.
+
+  ==============================================================================
+*/
+
+#include "FlangerTestUtilities.h"
+
+#if FLANGER_UNIT_TESTS
+
+//==============================================================================
+class InstanceTests  : public juce::UnitTest
+{
+public:
+    InstanceTests()  : juce::UnitTest ("Instances", "Flanger") {}
+
+    void runTest() override
+    {
+        beginTest ("Constructing and preparing 1000 instances");
+
+        const int numInstances = 1000;
+        const double sampleRate = 48000.0;
+        const int blockSize = 512;
+
+        // the first instance builds the shared tables; keep it alive so they aren't counted per instance
+        FlangerAudioProcessor first;
+        FlangerTestUtilities::prepare (first, sampleRate, blockSize);
+
+        std::vector<std::unique_ptr<FlangerAudioProcessor>> instances;
+        instances.reserve ((size_t) numInstances);
+
+        auto bytesBefore = FlangerTestUtilities::getResidentBytes();
+        auto start = juce::Time::getHighResolutionTicks();
+
+        for (int i = 0; i < numInstances; i++)
+            instances.push_back (std::make_unique<FlangerAudioProcessor>());
+
+        auto constructed = juce::Time::getHighResolutionTicks();
+
+        // realtime, as a host would prepare them: the delay lines wait for audio
+        for (auto& instance : instances)
+            FlangerTestUtilities::prepare (*instance, sampleRate, blockSize);
+
+        auto prepared = juce::Time::getHighResolutionTicks();
+        auto bytesPerInstance = (double) (FlangerTestUtilities::getResidentBytes() - bytesBefore) / numInstances;
+
+        auto constructSeconds = juce::Time::highResolutionTicksToSeconds (constructed - start);
+        auto prepareSeconds = juce::Time::highResolutionTicksToSeconds (prepared - constructed);
+
+        logMessage ("construct " + juce::String (1.0e6 * constructSeconds / numInstances, 1) + " us, prepare "
+                    + juce::String (1.0e6 * prepareSeconds / numInstances, 1) + " us per instance");
+
+        if (bytesBefore > 0)
+            logMessage ("resident memory " + juce::String (bytesPerInstance / 1024.0, 1) + " KB per instance");
+
+        auto numAllocated = 0;
+
+        for (auto& instance : instances)
+            if (instance->isDelayLineAllocated())
+                numAllocated++;
+
+        expectEquals (numAllocated, 0, "idle instances allocated their delay lines");
+
+        // parameters, the command queue, the user shape tables and a few small buffers
+        if (bytesBefore > 0)
+            expectLessThan (bytesPerInstance, 64.0 * 1024.0, "an idle instance holds too much memory");
+
+        for (auto& instance : instances)
+            instance->releaseResources();
+
+        instances.clear();
+        first.releaseResources();
+    }
+};
+
+static InstanceTests instanceTests;
+
+#endif
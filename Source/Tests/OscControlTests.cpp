@@ -0,0 +1,163 @@
+/*
+  ==============================================================================
+
+    OscControlTests.cpp
+
+    OSC control end to end over UDP on 127.0.0.1: latency from send to the
+    block that applies a message, and sustained throughput at a few thousand
+    messages per second with the audio thread neither dropping nor allocating.
+
+  ==============================================================================
+*/
+
+#include "FlangerTestUtilities.h"
+
+#if FLANGER_UNIT_TESTS
+
+#include <thread>
+
+//==============================================================================
+class OscControlTests  : public juce::UnitTest
+{
+public:
+    OscControlTests()  : juce::UnitTest ("OSC control", "Flanger") {}
+
+    void runTest() override
+    {
+        const double sampleRate = 48000.0;
+        const int blockSize = 64;
+
+        FlangerAudioProcessor processor;
+        processor.setNonRealtime (true);
+        FlangerTestUtilities::prepare (processor, sampleRate, blockSize);
+
+        int port = 0;
+
+        for (int candidate = 19100; candidate < 19200 && port == 0; candidate++)
+            if (processor.startOscControl (candidate))
+                port = candidate;
+
+        beginTest ("Latency from send to the block that applies it");
+
+        expect (port > 0, "no free UDP port to listen on");
+
+        if (port == 0)
+            return;
+
+        juce::OSCSender sender;
+        expect (sender.connect ("127.0.0.1", port), "could not connect the sender");
+
+        juce::AudioBuffer<float> block (2, blockSize);
+        juce::MidiBuffer midi;
+
+        auto processOneBlock = [&]
+        {
+            block.clear();
+            processor.processBlock (block, midi);
+        };
+
+        const int numProbes = 200;
+        double totalMicros = 0.0, worstMicros = 0.0;
+        int numApplied = 0;
+
+        for (int probe = 0; probe < numProbes; probe++)
+        {
+            // a value no earlier probe used, so its arrival is unambiguous
+            auto value = 0.1f + 0.001f * (float) probe;
+            auto startTicks = juce::Time::getHighResolutionTicks();
+            sender.send (juce::OSCAddressPattern ("/flanger/feedback"), value);
+
+            // blocks back to back, as a host would call them with no time budget left over
+            while (processor.mFeedbackGain != (double) value
+                    && juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - startTicks) < 1.0)
+                processOneBlock();
+
+            if (processor.mFeedbackGain != (double) value)
+                continue;
+
+            auto micros = 1.0e6 * juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - startTicks);
+            totalMicros += micros;
+            worstMicros = juce::jmax (worstMicros, micros);
+            numApplied++;
+        }
+
+        expectEquals (numApplied, numProbes, "some probes never arrived");
+
+        logMessage ("send to apply: mean " + juce::String (totalMicros / juce::jmax (1, numApplied), 1)
+                    + " us, worst " + juce::String (worstMicros, 1) + " us, plus up to one block ("
+                    + juce::String (1.0e6 * blockSize / sampleRate, 0) + " us) waiting for the callback on a real device");
+
+        beginTest ("5000 messages per second for two seconds, drained by processBlock");
+
+        const int messagesPerSecond = 5000;
+        const int numMessages = 2 * messagesPerSecond;
+
+        auto appliedBefore = processor.getNumCommandsApplied();
+        auto droppedBefore = processor.getNumCommandsDropped();
+
+        // the sender paces itself on its own thread while this one plays the audio thread
+        std::thread senderThread ([&sender]
+        {
+            auto startMs = juce::Time::getMillisecondCounterHiRes();
+
+            for (int i = 0; i < numMessages; i++)
+            {
+                auto dueMs = startMs + 1000.0 * i / messagesPerSecond;
+
+                while (juce::Time::getMillisecondCounterHiRes() < dueMs)
+                    juce::Thread::yield();
+
+                sender.send (juce::OSCAddressPattern ("/flanger/depth"), (float) (i % 100) / 100.0f);
+            }
+        });
+
+        const double periodMs = 1000.0 * blockSize / sampleRate;
+        auto startMs = juce::Time::getMillisecondCounterHiRes();
+        auto deadlineMs = startMs;
+        auto lastChangeMs = startMs;
+        int lastApplied = appliedBefore;
+        int allocations = 0;
+        int numBlocks = 0;
+
+        // one block per period, until nothing new has arrived for 200 ms
+        while (juce::Time::getMillisecondCounterHiRes() - lastChangeMs < 200.0
+                && juce::Time::getMillisecondCounterHiRes() - startMs < 10000.0)
+        {
+            deadlineMs += periodMs;
+
+            while (juce::Time::getMillisecondCounterHiRes() < deadlineMs)
+                juce::Thread::yield();
+
+            auto allocationsBefore = FlangerTestUtilities::getAllocationCount();
+            processOneBlock();
+            allocations += FlangerTestUtilities::getAllocationCount() - allocationsBefore;
+            numBlocks++;
+
+            if (processor.getNumCommandsApplied() != lastApplied)
+            {
+                lastApplied = processor.getNumCommandsApplied();
+                lastChangeMs = juce::Time::getMillisecondCounterHiRes();
+            }
+        }
+
+        senderThread.join();
+
+        auto applied = processor.getNumCommandsApplied() - appliedBefore;
+        auto seconds = (lastChangeMs - startMs) / 1000.0;
+
+        expectEquals (applied, numMessages, "not every message was applied");
+        expectEquals (processor.getNumCommandsDropped() - droppedBefore, 0, "the command queue overflowed");
+        expectEquals (allocations, 0, "processBlock allocated while draining commands");
+
+        logMessage (juce::String (applied) + " of " + juce::String (numMessages) + " messages applied in "
+                    + juce::String (seconds, 2) + " s (" + juce::String (applied / juce::jmax (seconds, 0.001), 0)
+                    + " msgs/s) over " + juce::String (numBlocks) + " blocks, "
+                    + juce::String ((double) applied / juce::jmax (1, numBlocks), 2) + " per block");
+
+        processor.stopOscControl();
+    }
+};
+
+static OscControlTests oscControlTests;
+
+#endif
@@ -0,0 +1,87 @@
+/*
+  ==============================================================================
+
+    SidechainTests.cpp
+
+    What the sidechain follower costs on top of the base flanger.
+
+  ==============================================================================
+*/
+
+#include "FlangerTestUtilities.h"
+
+#if FLANGER_UNIT_TESTS
+
+//==============================================================================
+class SidechainTests  : public juce::UnitTest
+{
+public:
+    SidechainTests()  : juce::UnitTest ("Sidechain", "Flanger") {}
+
+    void runTest() override
+    {
+        beginTest ("Sidechain cost over the base flanger");
+
+        const double sampleRate = 48000.0;
+        const int numSamples = 10 * (int) sampleRate;
+        const int blockSize = 64;
+
+        // main input noise, plus sidechain bursts 1234 samples on and off
+        juce::AudioBuffer<float> input (4, numSamples);
+        FlangerTestUtilities::fillWithNoise (input, 4);
+
+        for (int channel = 2; channel < 4; channel++)
+            for (int i = 0; i < numSamples; i++)
+                if ((i / 1234) % 2 == 1)
+                    input.setSample (channel, i, 0.0f);
+
+        double seconds[2];
+
+        for (int withSidechain = 0; withSidechain < 2; withSidechain++)
+        {
+            FlangerAudioProcessor processor;
+            processor.setNonRealtime (true);
+            FlangerTestUtilities::prepare (processor, sampleRate, blockSize, withSidechain == 1);
+
+            // both amounts on, so the follower drives the depth and the delay
+            if (withSidechain == 1)
+            {
+                processor.pushCommand ({ FlangerCommand::sidechainDepth, 0.7f });
+                processor.pushCommand ({ FlangerCommand::sidechainDelay, 0.4f });
+            }
+
+            // the base flanger only gets the main bus's channels
+            juce::AudioBuffer<float> buffer (processor.getTotalNumInputChannels(), numSamples);
+
+            // the first pass applies the commands, allocates the delay line and warms the caches
+            for (int channel = 0; channel < buffer.getNumChannels(); channel++)
+                buffer.copyFrom (channel, 0, input, channel, 0, numSamples);
+
+            FlangerTestUtilities::processInBlocks (processor, buffer, blockSize);
+
+            // best of three, so a preempted run doesn't decide the result
+            seconds[withSidechain] = 1.0e9;
+
+            for (int run = 0; run < 3; run++)
+            {
+                for (int channel = 0; channel < buffer.getNumChannels(); channel++)
+                    buffer.copyFrom (channel, 0, input, channel, 0, numSamples);
+
+                seconds[withSidechain] = juce::jmin (seconds[withSidechain],
+                                                     FlangerTestUtilities::processInBlocks (processor, buffer, blockSize));
+            }
+        }
+
+        auto overhead = seconds[1] / seconds[0] - 1.0;
+
+        logMessage ("base " + juce::String (1.0e9 * seconds[0] / numSamples, 1) + " ns/sample, with sidechain "
+                    + juce::String (1.0e9 * seconds[1] / numSamples, 1) + " ns/sample, "
+                    + juce::String (100.0 * overhead, 1) + "% more");
+
+        expectLessThan (overhead, 0.1, "the sidechain costs 10% or more over the base flanger");
+    }
+};
+
+static SidechainTests sidechainTests;
+
+#endif
@@ -0,0 +1,156 @@
+/*
+  ==============================================================================
+
+    WavetableLfoTests.cpp
+
+    Per-sample cost of the wavetable LFO against the atec::LFO it replaced.
+
+  ==============================================================================
+*/
+
+#include "FlangerTestUtilities.h"
+#include "../WavetableLfo.h"
+
+#if FLANGER_UNIT_TESTS
+
+//==============================================================================
+class WavetableLfoTests  : public juce::UnitTest
+{
+public:
+    WavetableLfoTests()  : juce::UnitTest ("Wavetable LFO", "Flanger") {}
+
+    void runTest() override
+    {
+        beginTest ("getNextSample against atec::LFO");
+
+        juce::SharedResourcePointer<SharedTables> sharedTables;
+        auto tables = sharedTables->getWaveTables (WAVETABLESIZE);
+
+        auto atecSine = timeAtecLfo (atec::LFO::sin);
+        auto atecSaw = timeAtecLfo (atec::LFO::saw);
+
+        auto tableSine = timeWavetableLfo (tables, (float) WaveTables::sine);
+        auto tableSaw = timeWavetableLfo (tables, (float) WaveTables::saw);
+        // halfway between two shapes reads both tables every sample: the worst case
+        auto tableMorph = timeWavetableLfo (tables, 0.5f);
+
+        logMessage ("atec::LFO     sine " + formatCost (atecSine) + ", saw " + formatCost (atecSaw));
+        logMessage ("WavetableLfo  sine " + formatCost (tableSine) + ", saw " + formatCost (tableSaw)
+                    + ", sine/saw morph " + formatCost (tableMorph));
+
+        // the tables buy six shapes and a morph; they shouldn't cost much more than the sine they replace
+        expectLessOrEqual (tableSine, 1.25 * atecSine, "the wavetable sine is much slower than atec::LFO's");
+        expectLessOrEqual (tableMorph, 1.25 * atecSine, "a morph between shapes is much slower than atec::LFO's sine");
+
+        beginTest ("A sample rate change mid-glide doesn't jump");
+
+        // what an eco toggle does: audio rate to one call per ECOSTRIDE samples
+        checkRateChange (tables, false);
+        checkRateChange (tables, true);
+    }
+
+private:
+    static constexpr double sampleRate = 48000.0;
+    static constexpr double lfoFreq = 1.3;
+    static constexpr int numSamples = 1 << 22;
+
+    template <typename NextSample>
+    static double timeBestOfThree (NextSample&& nextSample)
+    {
+        auto best = 1.0e9;
+        auto sum = 0.0;
+
+        for (int run = 0; run < 3; run++)
+        {
+            auto start = juce::Time::getHighResolutionTicks();
+
+            for (int i = 0; i < numSamples; i++)
+                sum += nextSample();
+
+            auto seconds = juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - start);
+            best = juce::jmin (best, seconds);
+        }
+
+        // keeps the loop from being optimised away
+        sink = sum;
+
+        return 1.0e9 * best / numSamples;
+    }
+
+    static double timeAtecLfo (atec::LFO::LfoType type)
+    {
+        atec::LFO lfo;
+        lfo.setType (type);
+        lfo.setSampleRate (sampleRate);
+        lfo.setFreq (lfoFreq);
+
+        return timeBestOfThree ([&lfo] { return (double) lfo.getNextSample(); });
+    }
+
+    static double timeWavetableLfo (std::shared_ptr<const WaveTables> tables, float morph)
+    {
+        WavetableLfo lfo;
+        lfo.setTables (std::move (tables));
+        lfo.setSampleRate (sampleRate);
+        lfo.setFreq (lfoFreq);
+        lfo.setMorph (morph);
+
+        // let the morph glide finish so every run times the steady state
+        for (int i = 0; i < (int) sampleRate; i++)
+            lfo.getNextSample();
+
+        return timeBestOfThree ([&lfo] { return (double) lfo.getNextSample(); });
+    }
+
+    // Holds the phase still so only the glide (or, with useShape, the crossfade)
+    // moves the output, then changes the rate halfway through it.
+    void checkRateChange (std::shared_ptr<const WaveTables> tables, bool useShape)
+    {
+        WavetableLfo lfo;
+        lfo.setTables (std::move (tables));
+        lfo.setSampleRate (sampleRate);
+        lfo.setFreq (0.0);
+        lfo.setPhase (0.3);
+
+        if (useShape)
+            lfo.setShape (WaveTables::saw);
+        else
+            lfo.setMorph ((float) WaveTables::saw);
+
+        auto previous = lfo.getNextSample();
+        auto largestStep = 0.0f;
+        auto lowest = previous, highest = previous;
+
+        for (int i = 0; i < (int) (0.1 * sampleRate); i++)
+        {
+            if (i == (int) (0.025 * sampleRate))
+                lfo.setSampleRate (sampleRate / ECOSTRIDE);
+
+            auto value = lfo.getNextSample();
+            largestStep = juce::jmax (largestStep, std::abs (value - previous));
+            lowest = juce::jmin (lowest, value);
+            highest = juce::jmax (highest, value);
+            previous = value;
+        }
+
+        auto what = juce::String (useShape ? "crossfade" : "morph glide");
+
+        // the remaining half of the ramp takes about 37 steps at the lower rate
+        expectLessThan (largestStep, 0.1f, "the " + what + " jumped when the sample rate changed");
+        expect (lowest >= 0.0f && highest <= 1.0f, "the " + what + " left the 0 to 1 range");
+        expectWithinAbsoluteError (previous, lfo.getNextSample(), 1.0e-6f, "the " + what + " never finished");
+    }
+
+    static juce::String formatCost (double nsPerSample)
+    {
+        return juce::String (nsPerSample, 2) + " ns/sample";
+    }
+
+    static volatile double sink;
+};
+
+volatile double WavetableLfoTests::sink = 0.0;
+
+static WavetableLfoTests wavetableLfoTests;
+
+#endif
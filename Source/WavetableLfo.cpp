@@ -0,0 +1,243 @@
+/*
+  ==============================================================================
+
+    WavetableLfo.cpp
+
+  ==============================================================================
+*/
+
+#include "WavetableLfo.h"
+
+// how long a morph glide or shape crossfade takes
+static constexpr double rampSeconds = 0.05;
+
+using LinearRamp = juce::SmoothedValue<float, juce::ValueSmoothingTypes::Linear>;
+
+// Glides from wherever the ramp is to target over rampSeconds. Every ramp starts
+// here, so one shortened by rescaleRamp() never leaks into the next.
+static void startRamp (LinearRamp& ramp, double sampleRate, float target) noexcept
+{
+    if (target == ramp.getTargetValue())
+        return;
+
+    auto current = ramp.getCurrentValue();
+    ramp.reset (sampleRate, rampSeconds);
+    ramp.setCurrentAndTargetValue (current);
+    ramp.setTargetValue (target);
+}
+
+// Keeps a running ramp's remaining time, in seconds, across a sample rate change
+static void rescaleRamp (LinearRamp& ramp, double oldSampleRate, double newSampleRate) noexcept
+{
+    if (! ramp.isSmoothing())
+    {
+        ramp.reset (newSampleRate, rampSeconds);
+        return;
+    }
+
+    auto current = ramp.getCurrentValue();
+    auto target = ramp.getTargetValue();
+
+    // the step isn't exposed, but a copy can take one
+    auto probe = ramp;
+    auto step = probe.getNextValue() - current;
+    auto remaining = step != 0.0f ? (double) ((target - current) / step) : 0.0;
+
+    ramp.reset (juce::jmax (1, juce::roundToInt (remaining * newSampleRate / oldSampleRate)));
+    ramp.setCurrentAndTargetValue (current);
+    ramp.setTargetValue (target);
+}
+
+//==============================================================================
+WavetableLfo::WavetableLfo()
+    : mUserTable (nullptr), mShapeA (nullptr), mShapeB (nullptr), mShapeIndex (-1),
+      mFromA (nullptr), mFromB (nullptr), mFromBlend (0.0f), mFromOffset (0.0f),
+      mSampleRate (48000.0), mFreq (0.0), mPhase (0.0), mIncrement (0.0)
+{
+    mMorph.reset (mSampleRate, rampSeconds);
+    mCrossfade.reset (mSampleRate, rampSeconds);
+    mCrossfade.setCurrentAndTargetValue (1.0f);
+}
+
+WavetableLfo::~WavetableLfo()
+{
+}
+
+void WavetableLfo::setTables (std::shared_ptr<const WaveTables> tables)
+{
+    jassert (tables == nullptr || tables->tableSize == WAVETABLESIZE);
+
+    // the crossfade's source shapes may belong to the old tables
+    mCrossfade.setCurrentAndTargetValue (1.0f);
+
+    mTables = std::move (tables);
+    mShapeIndex = -1;
+    updateShapePointers();
+}
+
+void WavetableLfo::setUserTable (const float* table) noexcept
+{
+    auto fromValue = getCurrentValue();
+    auto wasFading = mCrossfade.isSmoothing();
+
+    mUserTable = table;
+    mShapeIndex = -1;
+    updateShapePointers();
+
+    // a redrawn user shape fades in rather than stepping the delay time. The old table
+    // is the caller's to rewrite, so the fade starts from the new shapes plus an offset
+    if (mTables != nullptr && (wasFading || mShapeA == mUserTable || mShapeB == mUserTable))
+        beginCrossfade (mShapeA, mShapeB, mMorph.getCurrentValue() - (float) mShapeIndex, fromValue);
+}
+
+void WavetableLfo::setSampleRate (double sampleRate)
+{
+    // Called on every eco or governor tier switch, so a glide or crossfade in flight
+    // carries on for the time it had left instead of jumping to its end
+    if (sampleRate != mSampleRate)
+    {
+        rescaleRamp (mMorph, mSampleRate, sampleRate);
+        rescaleRamp (mCrossfade, mSampleRate, sampleRate);
+        mSampleRate = sampleRate;
+    }
+
+    updateShapePointers();
+    setFreq (mFreq);
+}
+
+void WavetableLfo::setFreq (double freq) noexcept
+{
+    mFreq = freq;
+    mIncrement = mFreq / mSampleRate;
+}
+
+void WavetableLfo::setPhase (double phase) noexcept
+{
+    mPhase = phase - std::floor (phase);
+}
+
+void WavetableLfo::setMorph (float morph) noexcept
+{
+    startRamp (mMorph, mSampleRate, juce::jlimit (0.0f, (float) WaveTables::numShapes, morph));
+}
+
+void WavetableLfo::setShape (int shape) noexcept
+{
+    if (mTables == nullptr)
+    {
+        mMorph.setCurrentAndTargetValue ((float) juce::jlimit (0, (int) WaveTables::numShapes, shape));
+        return;
+    }
+
+    auto fromValue = getCurrentValue();
+    auto fromA = mShapeA;
+    auto fromB = mShapeB;
+    auto fromBlend = mMorph.getCurrentValue() - (float) mShapeIndex;
+
+    mMorph.setCurrentAndTargetValue ((float) juce::jlimit (0, (int) WaveTables::numShapes, shape));
+    updateShapePointers();
+
+    beginCrossfade (fromA, fromB, fromBlend, fromValue);
+}
+
+//==============================================================================
+const float* WavetableLfo::getTable (int index) const noexcept
+{
+    if (index >= WaveTables::numShapes)
+        return mUserTable != nullptr ? mUserTable : mTables->getShape (WaveTables::sine);
+
+    return mTables->getShape (index);
+}
+
+void WavetableLfo::updateShapePointers() noexcept
+{
+    if (mTables == nullptr)
+        return;
+
+    auto index = juce::jmin ((int) mMorph.getCurrentValue(), (int) WaveTables::numShapes);
+
+    if (index == mShapeIndex)
+        return;
+
+    mShapeIndex = index;
+    mShapeA = getTable (index);
+    mShapeB = getTable (juce::jmin (index + 1, (int) WaveTables::numShapes));
+}
+
+static inline float readBlend (const float* a, const float* b, float blend, int index, float frac) noexcept
+{
+    auto valueA = a[index] + frac * (a[index + 1] - a[index]);
+    auto valueB = b[index] + frac * (b[index + 1] - b[index]);
+
+    return valueA + blend * (valueB - valueA);
+}
+
+float WavetableLfo::getCurrentValue() const noexcept
+{
+    if (mTables == nullptr || mShapeA == nullptr)
+        return 0.0f;
+
+    auto position = mPhase * WAVETABLESIZE;
+    auto index = (int) position;
+    auto frac = (float) (position - index);
+
+    auto value = readBlend (mShapeA, mShapeB, mMorph.getCurrentValue() - (float) mShapeIndex, index, frac);
+
+    if (mCrossfade.isSmoothing())
+    {
+        auto from = readBlend (mFromA, mFromB, mFromBlend, index, frac) + mFromOffset;
+        value = from + mCrossfade.getCurrentValue() * (value - from);
+    }
+
+    return value;
+}
+
+void WavetableLfo::beginCrossfade (const float* fromA, const float* fromB, float fromBlend, float fromValue) noexcept
+{
+    // the offset is zero unless something other than fromA/fromB was playing,
+    // e.g. a crossfade cut short, and keeps the first sample where the last one was
+    mFromA = fromA;
+    mFromB = fromB;
+    mFromBlend = fromBlend;
+
+    auto position = mPhase * WAVETABLESIZE;
+    auto index = (int) position;
+    mFromOffset = fromValue - readBlend (mFromA, mFromB, mFromBlend, index, (float) (position - index));
+
+    mCrossfade.setCurrentAndTargetValue (0.0f);
+    startRamp (mCrossfade, mSampleRate, 1.0f);
+}
+
+float WavetableLfo::getNextSample() noexcept
+{
+    if (mTables == nullptr)
+        return 0.0f;
+
+    if (mMorph.isSmoothing())
+    {
+        mMorph.getNextValue();
+        updateShapePointers();
+    }
+
+    auto position = mPhase * WAVETABLESIZE;
+    auto index = (int) position;
+    auto frac = (float) (position - index);
+
+    auto value = readBlend (mShapeA, mShapeB, mMorph.getCurrentValue() - (float) mShapeIndex, index, frac);
+
+    if (mCrossfade.isSmoothing())
+    {
+        auto amount = mCrossfade.getNextValue();
+        auto from = readBlend (mFromA, mFromB, mFromBlend, index, frac) + mFromOffset;
+        value = from + amount * (value - from);
+    }
+
+    mPhase += mIncrement;
+
+    if (mPhase >= 1.0)
+        mPhase -= 1.0;
+    else if (mPhase < 0.0)
+        mPhase += 1.0;
+
+    return value;
+}
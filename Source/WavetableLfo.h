@@ -0,0 +1,83 @@
+/*
+  ==============================================================================
+
+    WavetableLfo.h
+
+    Table-driven LFO with a continuous morph between waveforms.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "SharedTables.h"
+
+//==============================================================================
+/**
+    Reads the shared WaveTables (plus an optional per-instance user table) with
+    linear interpolation. The morph position runs from 0 to WaveTables::numShapes:
+    whole numbers select one shape in WaveTables::Shape order, with the user
+    table last, and anything in between crossfades the two neighbours. Morph
+    changes glide over 50 ms so moving the morph never jumps the delay time.
+
+    setShape() is for picking a shape outright: it crossfades from whatever
+    is playing straight to the new shape over the same 50 ms, without passing
+    through the shapes in between.
+
+    Output is unipolar, 0 to 1. Negative frequencies run the phase backwards.
+*/
+class WavetableLfo
+{
+public:
+    WavetableLfo();
+    ~WavetableLfo();
+
+    void setTables (std::shared_ptr<const WaveTables> tables);
+    /** Points the user shape at WAVETABLESIZE + 1 values owned by the caller, or nullptr for sine. */
+    void setUserTable (const float* table) noexcept;
+
+    /** Any glide or crossfade in flight keeps the time it had left. */
+    void setSampleRate (double sampleRate);
+    void setFreq (double freq) noexcept;
+    void setPhase (double phase) noexcept;
+    double getPhase() const noexcept { return mPhase; }
+
+    void setMorph (float morph) noexcept;
+    float getMorph() const noexcept { return mMorph.getTargetValue(); }
+    /** Crossfades directly to one shape, in WaveTables::Shape order with the user table last. */
+    void setShape (int shape) noexcept;
+
+    float getNextSample() noexcept;
+
+private:
+    const float* getTable (int index) const noexcept;
+    void updateShapePointers() noexcept;
+    float getCurrentValue() const noexcept;
+    void beginCrossfade (const float* fromA, const float* fromB, float fromBlend, float fromValue) noexcept;
+
+    std::shared_ptr<const WaveTables> mTables;
+    const float* mUserTable;
+
+    // the two neighbouring shapes the current morph position blends
+    const float* mShapeA;
+    const float* mShapeB;
+    int mShapeIndex;
+
+    juce::SmoothedValue<float, juce::ValueSmoothingTypes::Linear> mMorph;
+
+    // the shapes a setShape() crossfade starts from, frozen at their blend. The offset
+    // carries whatever else was playing (e.g. an unfinished crossfade) so the start is seamless
+    const float* mFromA;
+    const float* mFromB;
+    float mFromBlend;
+    float mFromOffset;
+    juce::SmoothedValue<float, juce::ValueSmoothingTypes::Linear> mCrossfade;
+
+    double mSampleRate;
+    double mFreq;
+    double mPhase;
+    double mIncrement;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (WavetableLfo)
+};